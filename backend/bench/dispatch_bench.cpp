@@ -0,0 +1,156 @@
+/**
+ * @file dispatch_bench.cpp
+ * @brief Compares the switch and the threaded dispatch of StackMachine
+ * with the RegisterMachine.
+ *
+ * Runs a nested arithmetic loop, laid out the way RPN::buildRPN() emits
+ * while loops, on every interpreter loop and prints the best time of
+ * each. Build with -DSIGMA_BUILD_BENCHMARKS=ON.
+ *
+ * Usage: dispatch_bench [outer iterations] [repetitions]
+ */
+#include <Bytecode.h>
+#include <RegisterMachine.h>
+#include <StackMachine.h>
+#include <cell.h>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+
+class CellBuilder {
+ public:
+  size_t Add(CellType type, const std::string& value) {
+    return Add(RPNCell(type, value));
+  }
+
+  size_t Add(const RPNCell& cell) {
+    cells_.push_back(cell);
+    return cells_.size() - 1;
+  }
+
+  void Patch(size_t jump, size_t target) {
+    cells_[jump].value = std::to_string(target);
+  }
+
+  const std::vector<RPNCell>& Cells() const { return cells_; }
+
+ private:
+  std::vector<RPNCell> cells_;
+};
+
+RPNCell Const(long value) {
+  return RPNCell(CellType::ConstCell, std::to_string(value));
+}
+
+RPNCell Load(const std::string& name) {
+  return RPNCell(CellType::LoadCell, name);
+}
+
+RPNCell Binary(Operator op, const std::string& text) {
+  return RPNCell(op, text, 2);
+}
+
+void Add(CellBuilder& builder, const std::vector<RPNCell>& expression) {
+  for (const RPNCell& cell : expression) {
+    builder.Add(cell);
+  }
+}
+
+void Assign(CellBuilder& builder, const std::string& name,
+            const std::vector<RPNCell>& expression) {
+  builder.Add(CellType::VarCell, name);
+  Add(builder, expression);
+  builder.Add(CellType::MathCell, "=");
+}
+
+/**
+ * @brief Builds
+ *
+ *   total = 0
+ *   i = 0
+ *   while i < outer:
+ *     j = 0
+ *     while j < 100:
+ *       total = total + j * 2 - 1
+ *       j = j + 1
+ *     i = i + 1
+ */
+std::vector<RPNCell> BuildLoop(long outer) {
+  CellBuilder builder;
+  Assign(builder, "total", {Const(0)});
+  Assign(builder, "i", {Const(0)});
+  size_t outerStart = builder.Add(CellType::LabelCell, "while_start_0");
+  Add(builder, {Load("i"), Const(outer), Binary(Operator::Less, "<")});
+  size_t outerExit = builder.Add(CellType::ConditionalJumpCell, "");
+  Assign(builder, "j", {Const(0)});
+  size_t innerStart = builder.Add(CellType::LabelCell, "while_start_2");
+  Add(builder, {Load("j"), Const(100), Binary(Operator::Less, "<")});
+  size_t innerExit = builder.Add(CellType::ConditionalJumpCell, "");
+  Assign(builder, "total",
+         {Load("total"), Load("j"), Const(2), Binary(Operator::Mul, "*"),
+          Binary(Operator::Add, "+"), Const(1), Binary(Operator::Sub, "-")});
+  Assign(builder, "j", {Load("j"), Const(1), Binary(Operator::Add, "+")});
+  builder.Patch(builder.Add(CellType::GoToCell, ""), innerStart);
+  builder.Patch(innerExit, builder.Add(CellType::LabelCell, "while_false_3"));
+  Assign(builder, "i", {Load("i"), Const(1), Binary(Operator::Add, "+")});
+  builder.Patch(builder.Add(CellType::GoToCell, ""), outerStart);
+  builder.Patch(outerExit, builder.Add(CellType::LabelCell, "while_false_1"));
+  return builder.Cells();
+}
+
+template <typename RunOnce>
+double BestMilliseconds(RunOnce run, int repetitions) {
+  double best = 0;
+  for (int r = 0; r < repetitions; ++r) {
+    auto start = std::chrono::steady_clock::now();
+    run();
+    std::chrono::duration<double, std::milli> elapsed =
+        std::chrono::steady_clock::now() - start;
+    if (r == 0 || elapsed.count() < best) {
+      best = elapsed.count();
+    }
+  }
+  return best;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  long outer = argc > 1 ? std::atol(argv[1]) : 20000;
+  int repetitions = argc > 2 ? std::atoi(argv[2]) : 5;
+  try {
+    Program program = BytecodeCompiler(BuildLoop(outer)).Compile();
+    RegisterProgram lowered = RegisterCompiler(program).Compile();
+    StackMachine machine(program);
+    RegisterMachine registerMachine(lowered);
+
+    double switchTime = BestMilliseconds(
+        [&] { machine.Run(Dispatch::Switch); }, repetitions);
+    double threadedTime = BestMilliseconds(
+        [&] { machine.Run(Dispatch::Threaded); }, repetitions);
+    double registerTime =
+        BestMilliseconds([&] { registerMachine.Run(); }, repetitions);
+
+    std::cout << "instructions: " << program.code.size() << " stack, "
+              << lowered.code.size() << " register, outer iterations: "
+              << outer << '\n';
+    std::cout << "switch:   " << switchTime << " ms\n";
+    std::cout << "threaded: " << threadedTime << " ms";
+    if (!SIGMA_HAS_COMPUTED_GOTO) {
+      std::cout << " (computed goto unavailable, same as switch)";
+    }
+    std::cout << '\n';
+    std::cout << "register: " << registerTime << " ms\n";
+    std::cout << "speedup:  " << switchTime / threadedTime
+              << "x threaded, " << switchTime / registerTime
+              << "x register\n";
+  } catch (const std::exception& e) {
+    std::cerr << "Error: " << e.what() << std::endl;
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,131 @@
+/**
+ * @file lexer_bench.cpp
+ * @brief Compares the scalar, SSE2 and AVX2 scan kernels of LexemAnalyzer.
+ *
+ * Generates a script of function definitions with long identifiers,
+ * numbers, string literals and comments, lexes it with every kernel set
+ * the CPU supports and prints the best time of each, then the times of
+ * AnalyzeParallel() with the given number of threads, of pulling every
+ * lexem with Next() and of Reanalyze() after a one-line edit in the middle
+ * of the script. Build with
+ * -DSIGMA_BUILD_BENCHMARKS=ON.
+ *
+ * Usage: lexer_bench [functions] [repetitions] [threads]
+ */
+#include <LexemAnalyzer.h>
+#include <Scan.h>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+namespace {
+
+std::string BuildScript(long functions) {
+  std::string script;
+  for (long i = 0; i < functions; ++i) {
+    std::string n = std::to_string(i);
+    script += "// generated function number " + n + "\n";
+    script += "def accumulate_measurements_" + n +
+              "(int first_measurement, int second_measurement):\n";
+    script += "    int running_total_" + n +
+              " = first_measurement * 1234567 + second_measurement / "
+              "89.125\n";
+    script += "    print(\"running total of generated function " + n +
+              " is ready\")\n";
+    script += "    return running_total_" + n + "\n";
+  }
+  return script;
+}
+
+template <typename RunOnce>
+double BestMilliseconds(RunOnce run, int repetitions) {
+  double best = 0;
+  for (int r = 0; r < repetitions; ++r) {
+    auto start = std::chrono::steady_clock::now();
+    run();
+    std::chrono::duration<double, std::milli> elapsed =
+        std::chrono::steady_clock::now() - start;
+    if (r == 0 || elapsed.count() < best) {
+      best = elapsed.count();
+    }
+  }
+  return best;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  long functions = argc > 1 ? std::atol(argv[1]) : 50000;
+  int repetitions = argc > 2 ? std::atoi(argv[2]) : 5;
+  unsigned threads = argc > 3 ? std::atoi(argv[3]) : 0;
+  try {
+    std::string script = BuildScript(functions);
+    std::cout << "source: " << script.size() << " bytes\n";
+    double scalarTime = 0;
+    for (ScanIsa isa : {ScanIsa::Scalar, ScanIsa::Sse2, ScanIsa::Avx2}) {
+      if (UseScanIsa(isa) != isa) {
+        std::cout << ScanIsaName(isa) << ": unavailable\n";
+        continue;
+      }
+      size_t lexems = 0;
+      double time = BestMilliseconds(
+          [&] {
+            LexemAnalyzer lexer(script);
+            lexer.Analyze();
+            lexems = lexer.GetLexems().size();
+          },
+          repetitions);
+      if (isa == ScanIsa::Scalar) {
+        scalarTime = time;
+      }
+      std::cout << ScanIsaName(isa) << ": " << time << " ms, " << lexems
+                << " lexems, " << scalarTime / time << "x\n";
+    }
+
+    UseScanIsa(DetectScanIsa());
+    double parallelTime = BestMilliseconds(
+        [&] {
+          LexemAnalyzer lexer(script);
+          lexer.AnalyzeParallel(threads);
+        },
+        repetitions);
+    std::cout << "parallel: " << parallelTime << " ms\n";
+
+    size_t pulled = 0;
+    double streamTime = BestMilliseconds(
+        [&] {
+          LexemAnalyzer lexer(script);
+          pulled = 0;
+          while (lexer.Next().get_type() != LexemType::EOC) {
+            ++pulled;
+          }
+        },
+        repetitions);
+    std::cout << "stream: " << streamTime << " ms, " << pulled + 1
+              << " lexems\n";
+
+    std::string edited = script;
+    size_t line = edited.find("1234567", script.size() / 2);
+    edited.replace(line, 7, "7654321 + 1");
+    LexemAnalyzer lexer(script);
+    lexer.Analyze();
+    bool toEdited = true;
+    double time = BestMilliseconds(
+        [&] {
+          if (toEdited) {
+            lexer.Reanalyze(edited, line, 7, 11);
+          } else {
+            lexer.Reanalyze(script, line, 11, 7);
+          }
+          toEdited = !toEdited;
+        },
+        repetitions);
+    std::cout << "reanalyze one line: " << time * 1000 << " us, "
+              << lexer.GetLexems().size() << " lexems\n";
+  } catch (const std::exception& e) {
+    std::cerr << "Error: " << e.what() << std::endl;
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,245 @@
+#ifndef BACKEND_AST_H
+#define BACKEND_AST_H
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "Interner.h"
+#include "Lexem.h"
+
+/**
+ * @file Ast.h
+ * @brief Syntax tree built once by SyntaxAnalyzer and shared by the later
+ * passes
+ *
+ * SemanticAnalyzer annotates the nodes in place and RPN walks them to emit
+ * the cells, so neither pass goes back to the token stream. Every node and
+ * every list of nodes is allocated from the Arena of its Ast and freed with
+ * it in one go; nodes are therefore trivially destructible. Names are
+ * interned ids (see Interner.h); type names and expressions are views into
+ * the source buffer, which must outlive the tree.
+ */
+
+/**
+ * @class Arena
+ * @brief Bump allocator for objects that are released all at once
+ *
+ * Memory is carved from blocks of kBlockSize bytes; an allocation that
+ * does not fit into the rest of the current block starts a new one (or gets
+ * a block of its own when it is larger than kBlockSize). Nothing is freed
+ * before the arena is destroyed and no destructor is ever run, so only
+ * trivially destructible types may be created.
+ */
+class Arena {
+ public:
+  static constexpr size_t kBlockSize = 64 * 1024;
+
+  Arena() = default;
+  Arena(const Arena&) = delete;
+  Arena& operator=(const Arena&) = delete;
+
+  void* Allocate(size_t size, size_t align);
+
+  template <typename T, typename... Args>
+  T* New(Args&&... args) {
+    static_assert(std::is_trivially_destructible_v<T>,
+                  "arena objects are never destroyed");
+    return new (Allocate(sizeof(T), alignof(T)))
+        T(std::forward<Args>(args)...);
+  }
+
+  size_t BytesUsed() const { return used_; }
+
+ private:
+  std::vector<std::unique_ptr<char[]>> blocks_;
+  char* cursor_ = nullptr;
+  char* end_ = nullptr;
+  size_t used_ = 0;
+};
+
+/**
+ * @brief Fixed-size array allocated from an Arena
+ */
+template <typename T>
+struct Span {
+  T* data = nullptr;
+  size_t size = 0;
+
+  T* begin() const { return data; }
+  T* end() const { return data + size; }
+  bool empty() const { return size == 0; }
+  T& operator[](size_t i) const { return data[i]; }
+  T& front() const { return data[0]; }
+
+  static Span Copy(Arena& arena, const std::vector<T>& items) {
+    static_assert(std::is_trivially_destructible_v<T>,
+                  "arena objects are never destroyed");
+    Span span;
+    span.size = items.size();
+    if (!items.empty()) {
+      span.data = static_cast<T*>(
+          arena.Allocate(sizeof(T) * items.size(), alignof(T)));
+      std::uninitialized_copy(items.begin(), items.end(), span.data);
+    }
+    return span;
+  }
+};
+
+/**
+ * @enum ValueType
+ * @brief Type of a variable or an expression, filled in by SemanticAnalyzer
+ */
+enum class ValueType : uint8_t {
+  Unknown,
+  Int,
+  Float,
+  Bool,
+  Char,
+  String,
+  Void
+};
+
+ValueType FindValueType(std::string_view name);
+const char* ValueTypeName(ValueType type);
+
+/**
+ * @brief Expression as the lexems it is made of
+ *
+ * The tokens run up to, not including, the delimiter that ended the
+ * expression; brackets inside are balanced. SemanticAnalyzer sets type to
+ * the type of the value.
+ */
+struct Expression {
+  Span<Lexem> tokens;
+  size_t line = 0;
+  ValueType type = ValueType::Unknown;
+};
+
+/**
+ * @enum NodeKind
+ * @brief Kind of a statement node, tells which struct it is
+ */
+enum class NodeKind : uint8_t {
+  Function,
+  Declaration,
+  Assignment,
+  Call,
+  If,
+  While,
+  For,
+  Print,
+  Return,
+  Jump
+};
+
+struct Statement {
+  NodeKind kind;
+  size_t line = 0;
+
+ protected:
+  explicit Statement(NodeKind k) : kind(k) {}
+};
+
+using Block = Span<Statement*>;
+
+struct Parameter {
+  std::string_view type;
+  SymbolId name = kNoSymbol;
+};
+
+/** def name(type name, ...): body */
+struct FunctionNode : Statement {
+  FunctionNode() : Statement(NodeKind::Function) {}
+  SymbolId name = kNoSymbol;
+  Span<Parameter> parameters;
+  Block body;
+};
+
+/**
+ * type name [= value]; an array declaration has a size and, when it is
+ * initialized with braces, one element per value.
+ */
+struct DeclarationNode : Statement {
+  DeclarationNode() : Statement(NodeKind::Declaration) {}
+  std::string_view typeName;
+  SymbolId name = kNoSymbol;
+  ValueType type = ValueType::Unknown;
+  Expression* value = nullptr;
+  Expression* size = nullptr;
+  Span<Expression*> elements;
+};
+
+/** name = value; target is the declared type of the variable */
+struct AssignmentNode : Statement {
+  AssignmentNode() : Statement(NodeKind::Assignment) {}
+  SymbolId name = kNoSymbol;
+  Expression* value = nullptr;
+  ValueType target = ValueType::Unknown;
+};
+
+/** name(arguments); as a statement */
+struct CallNode : Statement {
+  CallNode() : Statement(NodeKind::Call) {}
+  SymbolId name = kNoSymbol;
+  Span<Expression*> arguments;
+};
+
+/** if (condition): then [else: otherwise] */
+struct IfNode : Statement {
+  IfNode() : Statement(NodeKind::If) {}
+  Expression* condition = nullptr;
+  Block then;
+  Block otherwise;
+  bool hasElse = false;
+};
+
+/** while (condition): body */
+struct WhileNode : Statement {
+  WhileNode() : Statement(NodeKind::While) {}
+  Expression* condition = nullptr;
+  Block body;
+};
+
+/** for variable in range(bound): body */
+struct ForNode : Statement {
+  ForNode() : Statement(NodeKind::For) {}
+  SymbolId variable = kNoSymbol;
+  Expression* bound = nullptr;
+  Block body;
+};
+
+/** print(value) */
+struct PrintNode : Statement {
+  PrintNode() : Statement(NodeKind::Print) {}
+  Expression* value = nullptr;
+};
+
+/** return [value]; value has no tokens when it is omitted */
+struct ReturnNode : Statement {
+  ReturnNode() : Statement(NodeKind::Return) {}
+  Expression* value = nullptr;
+};
+
+/** break or continue */
+struct JumpNode : Statement {
+  JumpNode() : Statement(NodeKind::Jump) {}
+  Keyword keyword = Keyword::None;
+  std::string_view text;
+};
+
+/**
+ * @brief Syntax tree of a program and the arena its nodes live in
+ */
+struct Ast {
+  Arena arena;
+  Block program;
+};
+
+#endif  // BACKEND_AST_H
@@ -1,141 +1,157 @@
-#include <string>
-#include <utility>
-#include "Lexem.h"
+#pragma once
 
-/**
- * @brief Represents a vertex (node) in a trie data structure
- * 
- * A vertex in the trie contains:
- * - An array of pointers to child vertices (256 possible children for each ASCII character)
- * - A boolean flag indicating whether this vertex represents the end of a word
- */
-struct vertex {
-  vertex* to[256] = {nullptr};
-  bool terminal = false;
-};
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
 
 /**
  * @file Bor.h
- * @brief Implementation of a trie (prefix tree) data structure for string matching
- * 
- * This file contains the implementation of a trie data structure used for efficient
- * string matching and storage. The trie enables quick insertion and lookup of strings,
- * making it particularly useful for keyword recognition in lexical analysis.
- * 
+ * @brief Double-array trie (prefix tree) used for keyword recognition
+ *
+ * The trie is stored in two parallel integer arrays instead of one heap
+ * node per character. A transition from state s on byte c goes to
+ * t = base[s] + c + 1 and exists only if check[t] == s. Terminal states
+ * hold the id of the keyword ending there.
+ *
  * The trie supports:
- * - Adding new strings (O(m) time complexity, where m is string length)
- * - Checking for string existence (O(m) time complexity)
- * - String matching with lexeme generation
- * 
- * The implementation uses dynamic memory allocation for vertices and includes proper
- * cleanup through a destructor.
- * 
- * @note The implementation assumes ASCII character set (256 possible characters)
- * @see vertex class for the node structure used in the trie
+ * - Adding new strings (rebuilds the arrays; keyword sets are small and
+ *   only loaded once)
+ * - Looking up a string in O(m) time without allocating, where m is the
+ *   string length
+ *
+ * @note The implementation assumes 8-bit characters (256 possible bytes)
  */
 class bor {
  public:
+  bor() { build(); }
+
   /**
    * @brief Adds a string to the trie data structure
-   * 
-   * This function traverses the trie character by character, creating new vertices
-   * as needed, and marks the last vertex as terminal.
-   * 
+   *
+   * Strings get consecutive ids in the order they are first added.
+   *
    * @param s The string to be added to the trie
-   * 
-   * Time Complexity: O(|s|) where |s| is the length of the input string
-   * Space Complexity: O(|s|) in worst case when creating new vertices
+   * @return int The id of the string
    */
-  void add(const std::string& s) {
-    vertex* v = v0;
-    for (char c : s) {
-      unsigned char uc = static_cast<unsigned char>(c);
-      if (!v->to[uc]) {
-        v->to[uc] = new vertex;
-      }
-      v = v->to[uc];
+  int add(const std::string& s) {
+    int id = find(s.data(), s.size());
+    if (id >= 0) {
+      return id;
     }
-    v->terminal = true;
+    words_.push_back(s);
+    build();
+    return static_cast<int>(words_.size()) - 1;
   }
 
-  void print() { printVertex(v0); }
-
   /**
-   * @brief Checks if a given string exists in the trie and returns the corresponding lexeme
+   * @brief Looks a string up in the trie
    * @param s Pointer to the character array to check
    * @param size Length of the string to check
-   * @param s_index Starting index of the string in the source code
-   * @return std::pair<bool, Lexem> First element indicates if string was found,
-   *         second element contains the constructed Lexem regardless of whether string was found
-   * 
-   * The function traverses the trie character by character checking if the given string
-   * exists. If at any point a character is not found in the trie, returns false with
-   * a partial lexeme. If the entire string is found and ends at a terminal node,
-   * returns true with the complete lexeme. Otherwise returns false with the complete
-   * but non-terminal lexeme.
+   * @return int The id given by add(), or -1 if the string was never added
    */
-  std::pair<bool, Lexem> has(const char* s, size_t size, size_t s_index) {
-    vertex* cur = v0;
-    std::string line;
-
+  int find(const char* s, size_t size) const {
+    int32_t state = 0;
     for (size_t i = 0; i < size; ++i) {
-      unsigned char c = static_cast<unsigned char>(s[i]);
-      if (!cur->to[c]) {
-        return {false,
-                Lexem(LexemType::KEYWORD, line, s_index, s_index + i, 0)};
-      }
-      cur = cur->to[c];
-      line.push_back(s[i]);
-
-      if (cur->terminal && i == size - 1) {
-        return {true,
-                Lexem(LexemType::KEYWORD, line, s_index, s_index + i + 1, 0)};
+      size_t next = static_cast<size_t>(base_[state]) +
+                    static_cast<unsigned char>(s[i]) + 1;
+      if (next >= check_.size() || check_[next] != state) {
+        return -1;
       }
+      state = static_cast<int32_t>(next);
     }
-    return {false, Lexem(LexemType::KEYWORD, line, s_index, s_index + size, 0)};
+    return keyword_[state];
   }
 
-  ~bor() { deleteVertex(v0); }
+  /**
+   * @brief Returns the string added with the given id
+   */
+  const std::string& word(int id) const { return words_[id]; }
+
+  size_t size() const { return words_.size(); }
 
  private:
-  vertex* v0 = new vertex;
+  std::vector<int32_t> base_;
+  std::vector<int32_t> check_;
+  std::vector<int32_t> keyword_;
+  std::vector<std::string> words_;
 
   /**
-   * @brief Recursively traverses and prints the vertices of a trie data structure
-   * 
-   * This function performs a depth-first traversal of the trie starting from the given vertex.
-   * It visits each child vertex and recursively processes their children.
-   * 
-   * @param v Pointer to the current vertex in the trie
-   * @note If the input vertex is nullptr, the function returns without doing anything
+   * @brief Lays out the states of all added strings from scratch
+   *
+   * States are placed depth-first from the root (state 0). For every state
+   * the smallest base is chosen such that all of its outgoing transitions
+   * land on free cells.
    */
-  void printVertex(vertex* v) {
-    if (!v)
-      return;
-    for (auto& next : v->to) {
-      if (next) {
-        printVertex(next);
-      }
+  void build() {
+    std::vector<int> order(words_.size());
+    for (size_t i = 0; i < order.size(); ++i) {
+      order[i] = static_cast<int>(i);
     }
+    std::sort(order.begin(), order.end(),
+              [this](int a, int b) { return words_[a] < words_[b]; });
+    base_.assign(1, 0);
+    check_.assign(1, -1);
+    keyword_.assign(1, -1);
+    place(0, 0, order, 0, order.size());
   }
 
   /**
-   * @brief Recursively deletes a vertex and all its descendants in the trie
-   * 
-   * This function performs a post-order traversal of the trie starting from the given vertex,
-   * deleting all child vertices before deleting the vertex itself. This ensures proper cleanup
-   * of the entire subtree rooted at the given vertex.
-   * 
-   * @param v Pointer to the vertex to be deleted
+   * @brief Places the children of a state
+   *
+   * @param state State whose children are placed
+   * @param depth Length of the prefix the state stands for
+   * @param order Ids of the strings, sorted by their text
+   * @param lo First string (in order) sharing the prefix
+   * @param hi One past the last string sharing the prefix
    */
-  void deleteVertex(vertex* v) {
-    if (!v)
+  void place(int32_t state, size_t depth, const std::vector<int>& order,
+             size_t lo, size_t hi) {
+    std::vector<std::pair<int, std::pair<size_t, size_t>>> children;
+    for (size_t i = lo; i < hi;) {
+      const std::string& w = words_[order[i]];
+      if (w.size() == depth) {
+        keyword_[state] = order[i];
+        ++i;
+        continue;
+      }
+      int code = static_cast<unsigned char>(w[depth]) + 1;
+      size_t j = i;
+      while (j < hi && words_[order[j]].size() > depth &&
+             static_cast<unsigned char>(words_[order[j]][depth]) + 1 == code) {
+        ++j;
+      }
+      children.push_back({code, {i, j}});
+      i = j;
+    }
+    if (children.empty()) {
       return;
-    for (auto& next : v->to) {
-      if (next) {
-        deleteVertex(next);
+    }
+
+    int32_t base = 0;
+    for (;; ++base) {
+      bool free = true;
+      for (const auto& child : children) {
+        size_t cell = static_cast<size_t>(base + child.first);
+        free = free && (cell >= check_.size() || check_[cell] == -1);
+      }
+      if (free) {
+        break;
       }
     }
-    delete v;
+    base_[state] = base;
+    size_t last = static_cast<size_t>(base + children.back().first);
+    if (last >= check_.size()) {
+      base_.resize(last + 1, 0);
+      check_.resize(last + 1, -1);
+      keyword_.resize(last + 1, -1);
+    }
+    for (const auto& child : children) {
+      check_[base + child.first] = state;
+    }
+    for (const auto& child : children) {
+      place(base + child.first, depth + 1, order, child.second.first,
+            child.second.second);
+    }
   }
-};
\ No newline at end of file
+};
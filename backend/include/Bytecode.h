@@ -0,0 +1,150 @@
+#ifndef BACKEND_BYTECODE_H
+#define BACKEND_BYTECODE_H
+
+#pragma once
+
+#include <cell.h>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+#include "Value.h"
+
+/**
+ * @enum OpCode
+ * @brief Operations of the bytecode executed by the StackMachine
+ *
+ * - PushConst: push constants[arg]
+ * - LoadGlobal/StoreGlobal: read/write global slot arg
+ * - LoadLocal/StoreLocal: read/write slot arg of the current frame
+ * - Add..Or: pop two operands, push the result
+ * - Not, Negate: pop an operand, push the result
+ * - Jump/JumpIfFalse: continue at instruction arg (JumpIfFalse pops)
+ * - Call: call through callSites[arg] with the arguments on the stack
+ * - Return: pop the return value and leave the function
+ * - Leave: leave the function at its end
+ * - Print: pop a value and print it
+ */
+enum class OpCode : uint8_t {
+  PushConst,
+  LoadGlobal,
+  StoreGlobal,
+  LoadLocal,
+  StoreLocal,
+  Add,
+  Sub,
+  Mul,
+  Div,
+  Mod,
+  Less,
+  Greater,
+  LessEqual,
+  GreaterEqual,
+  Equal,
+  NotEqual,
+  And,
+  Or,
+  Not,
+  Negate,
+  Jump,
+  JumpIfFalse,
+  Call,
+  Return,
+  Leave,
+  Print
+};
+
+/**
+ * @brief A single fixed-width instruction: 8-bit opcode, 24-bit operand
+ */
+struct Instruction {
+  OpCode op : 8;
+  uint32_t arg : 24;
+};
+
+static_assert(sizeof(Instruction) == 4, "Instruction must stay 4 bytes");
+
+/**
+ * @brief Function table entry of a compiled program
+ */
+struct FunctionInfo {
+  std::string name;
+  uint32_t entry;
+  uint32_t arity;
+  uint32_t frameSize;
+  std::vector<std::string> localNames;
+};
+
+/**
+ * @brief One call in the source: the name it calls and the function table
+ * entry that name resolved to when the program was compiled
+ *
+ * Every Call instruction has its own site, so an interpreter can keep a
+ * per-site inline cache of the callee.
+ */
+struct CallSite {
+  std::string name;
+  uint32_t function;
+};
+
+/**
+ * @brief A compiled program: instruction stream and the pools it indexes
+ */
+struct Program {
+  std::vector<Instruction> code;
+  std::vector<Value> constants;
+  std::vector<std::string> globalNames;
+  std::vector<FunctionInfo> functions;
+  std::vector<CallSite> callSites;
+};
+
+/**
+ * @class BytecodeCompiler
+ * @brief Lowers the cells produced by RPN::buildRPN() into a Program
+ *
+ * Every Const, Load and Math cell of an expression becomes one
+ * instruction. Labels disappear: jumps are
+ * resolved to instruction indices, calls to function table indices and
+ * variables to global or frame slots.
+ *
+ * Inside a function, parameters and variables assigned in its body are
+ * frame slots unless the same name is assigned at top level. Names are
+ * resolved through flat tables indexed by their interned SymbolId.
+ *
+ * @throws std::runtime_error on malformed cells or unresolved names
+ */
+class BytecodeCompiler {
+ public:
+  BytecodeCompiler(const std::vector<RPNCell>& rpn);
+  Program Compile();
+
+ private:
+  std::vector<RPNCell> rpn_;
+  Program program_;
+  std::map<std::string, uint32_t> constantIndex_;
+  std::vector<uint32_t> globalIndex_;
+  std::map<size_t, uint32_t> functionAtCell_;
+  std::vector<uint32_t> localIndex_;
+  std::vector<bool> topLevelNames_;
+  std::vector<size_t> functionCells_;
+  std::vector<std::vector<SymbolId>> functionLocals_;
+  std::vector<uint32_t> cellToInstruction_;
+  std::vector<std::pair<uint32_t, size_t>> jumpFixups_;
+  int currentFunction_ = -1;
+
+  void CollectFunctions();
+  void CollectLocals(size_t definition, FunctionInfo& function);
+  void CompileOperator(const RPNCell& cell);
+  void CompileLoad(SymbolId name);
+  void CompileStore(SymbolId name);
+  void EnterFunction(uint32_t function);
+  void LeaveFunction();
+  size_t ResolveJump(size_t index) const;
+  size_t FindFunctionEnd(size_t index) const;
+  uint32_t AddConstant(const std::string& literal);
+  uint32_t LocalSlot(SymbolId name) const;
+  uint32_t GlobalSlot(SymbolId name);
+  void Emit(OpCode op, uint32_t arg = 0);
+};
+
+#endif  // BACKEND_BYTECODE_H
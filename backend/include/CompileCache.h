@@ -0,0 +1,82 @@
+#ifndef BACKEND_COMPILECACHE_H
+#define BACKEND_COMPILECACHE_H
+
+#pragma once
+
+#include <cell.h>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "Bor.h"
+#include "Optimizer.h"
+
+/**
+ * @brief What the frontend produces for a program: everything RunProgram()
+ * needs to list and run it without lexing, parsing or optimizing it again
+ */
+struct CompiledProgram {
+  // The cells as RPN::buildRPN() built them, which the listing shows
+  std::vector<RPNCell> listing;
+  // The cells after Optimizer::Run(), which are executed
+  std::vector<RPNCell> cells;
+  OptimizerStats stats;
+};
+
+/**
+ * @brief Counters of a CompileCache since it was opened
+ */
+struct CacheStats {
+  size_t hits = 0;
+  size_t misses = 0;
+  size_t stores = 0;
+  size_t evictions = 0;
+};
+
+/**
+ * @class CompileCache
+ * @brief Content-addressed store of compiled programs in a local directory
+ *
+ * An entry is found by a key: the text of everything the compiled program
+ * depends on, i.e. the source, the keyword set and the optimization level
+ * (see Key()). Its file is named after a 64-bit FNV-1a hash of the key and
+ * holds the key itself, so two keys sharing a hash only cost a miss, never
+ * a wrong program.
+ *
+ * Names are stored as text and interned again when an entry is loaded,
+ * since SymbolIds are only meaningful inside one process. Entries are
+ * written in the byte order of the machine; an entry that does not parse
+ * is treated as a miss and removed.
+ *
+ * The directory is bounded to capacity bytes with least-recently-used
+ * eviction: a hit refreshes the modification time of its entry, and after
+ * every store the oldest entries are removed until the rest fit. Entries
+ * are written to a temporary file and renamed into place, so several
+ * processes may share the directory.
+ *
+ * @throws std::runtime_error if the directory cannot be created
+ */
+class CompileCache {
+ public:
+  static constexpr uint64_t kDefaultCapacity = 64 << 20;
+
+  CompileCache(std::string directory, uint64_t capacity = kDefaultCapacity);
+
+  static std::string Key(std::string_view code, const bor* keywords,
+                         int optimizationLevel);
+
+  std::optional<CompiledProgram> Lookup(const std::string& key);
+  void Store(const std::string& key, const CompiledProgram& program);
+  const CacheStats& Stats() const { return stats_; }
+
+ private:
+  std::string directory_;
+  uint64_t capacity_;
+  CacheStats stats_;
+
+  std::string PathOf(const std::string& key) const;
+  void Evict();
+};
+
+#endif  // BACKEND_COMPILECACHE_H
@@ -0,0 +1,70 @@
+#ifndef BACKEND_CPPEMITTER_H
+#define BACKEND_CPPEMITTER_H
+
+#pragma once
+
+#include <cell.h>
+#include <map>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+#include "Semantic.h"
+
+/**
+ * @class CppEmitter
+ * @brief Translates an RPN program into a standalone C++ translation unit
+ *
+ * Every `def` becomes a C++ function, the top level code becomes main().
+ * Variables get the C++ type of their declared type as recorded by
+ * SemanticAnalyzer (int and bool: long long, float: double, string and
+ * char: std::string), so arithmetic compiles to native instructions.
+ * Labels and jumps map to C++ labels and goto; all variables of a function
+ * are declared at its top so no jump crosses an initialization.
+ *
+ * Variables follow the same rule as BytecodeCompiler: parameters and names
+ * assigned in a function are its locals unless the name is assigned at top
+ * level.
+ *
+ * @throws std::runtime_error if a variable has no recorded type or the
+ *         cells are malformed
+ */
+class CppEmitter {
+ public:
+  CppEmitter(const std::vector<RPNCell>& rpn, const SemanticAnalyzer& semantic);
+  std::string Emit();
+  static void BuildExecutable(const std::string& sourcePath,
+                              const std::string& outputPath);
+
+ private:
+  struct Function {
+    std::string name;
+    SymbolId symbol;
+    size_t body;
+    size_t end;
+    std::vector<std::string> parameters;
+    std::set<std::string> locals;
+  };
+
+  std::vector<RPNCell> rpn_;
+  std::map<SymbolId, std::map<SymbolId, ValueType>> types_;
+  std::map<SymbolId, std::vector<ValueType>> signatures_;
+  std::vector<Function> functions_;
+  std::map<size_t, size_t> functionAtCell_;
+  std::set<std::string> topLevelNames_;
+  const Function* current_ = nullptr;
+  std::vector<std::string> stack_;
+
+  void CollectFunctions();
+  size_t FindFunctionEnd(size_t index) const;
+  std::string EmitFunction(const Function& function);
+  std::string EmitStatements(size_t begin, size_t end);
+  std::string Operation(const RPNCell& cell);
+  std::string Literal(const std::string& literal) const;
+  std::string Variable(const std::string& name) const;
+  std::string TypeOf(const std::string& name) const;
+  std::string JumpTarget(size_t index) const;
+  std::string Pop();
+};
+
+#endif  // BACKEND_CPPEMITTER_H
@@ -0,0 +1,39 @@
+#ifndef BACKEND_DRIVER_H
+#define BACKEND_DRIVER_H
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include "Bor.h"
+#include "StackMachine.h"
+
+class CompileCache;
+
+/**
+ * @brief Command line options that shape how a program is compiled and run
+ */
+struct RunOptions {
+  int optimizationLevel = 1;
+  bool printStats = false;
+  bool useRegisterMachine = false;
+  uint32_t jitThreshold = StackMachine::kDefaultJitThreshold;
+  unsigned lexThreads = 1;
+  std::string emit;
+  // Write the program image to outputPath instead of running the program
+  bool compileOnly = false;
+  std::string outputPath;
+  // Custom keyword set from LexemAnalyzer::LoadKeywords(), null for the
+  // built-in keywords
+  std::shared_ptr<const bor> keywords;
+  // Compiled programs to reuse, null to always compile; a resident server
+  // shares one across its requests
+  std::shared_ptr<CompileCache> cache;
+};
+
+int RunProgram(std::string_view code, const RunOptions& options);
+int RunImage(const std::string& path, const RunOptions& options);
+
+#endif  // BACKEND_DRIVER_H
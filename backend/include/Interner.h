@@ -0,0 +1,38 @@
+#ifndef BACKEND_INTERNER_H
+#define BACKEND_INTERNER_H
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+/**
+ * @file Interner.h
+ * @brief Process-wide table giving every distinct identifier a dense
+ * integer id
+ *
+ * LexemAnalyzer interns the text of each IDENTIFIER lexem once; from then
+ * on the tree, the semantic analyzer, the cells and the bytecode compiler
+ * compare and index names by id, so a scope lookup or a call resolution is
+ * an integer comparison or an array load instead of a string comparison.
+ * Ids are assigned in first-seen order from 0 and are never released; the
+ * names are copied, so they outlive the source they were read from.
+ *
+ * A SymbolId names a user identifier and is unrelated to the Symbol enum of
+ * Lexem.h, which tells the operators and brackets apart.
+ *
+ * All functions may be called from several threads at once, which
+ * LexemAnalyzer::AnalyzeParallel() does.
+ */
+
+using SymbolId = uint32_t;
+
+inline constexpr SymbolId kNoSymbol = UINT32_MAX;
+
+SymbolId InternSymbol(std::string_view name);
+SymbolId LookupSymbol(std::string_view name);
+std::string_view SymbolName(SymbolId id);
+size_t SymbolCount();
+
+#endif  // BACKEND_INTERNER_H
@@ -0,0 +1,94 @@
+#ifndef BACKEND_JIT_H
+#define BACKEND_JIT_H
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <map>
+#include <memory>
+#include <vector>
+#include "Bytecode.h"
+
+#if defined(__x86_64__) && defined(__linux__)
+#define SIGMA_HAS_JIT 1
+#else
+#define SIGMA_HAS_JIT 0
+#endif
+
+#ifndef SIGMA_JIT_ENABLED
+#define SIGMA_JIT_ENABLED SIGMA_HAS_JIT
+#endif
+
+/**
+ * @class NativeFunction
+ * @brief Machine code of a function compiled by JitCompiler
+ *
+ * The code works on one array of 64-bit integer slots: the frame slots of
+ * the function followed by a copy of every global it uses, in the order of
+ * Globals(). It owns its executable pages and unmaps them when destroyed.
+ */
+class NativeFunction {
+ public:
+  using Entry = int64_t (*)(int64_t* slots);
+
+  NativeFunction(void* memory, size_t size, uint32_t frameSize,
+                 std::vector<uint32_t> globals);
+  ~NativeFunction();
+  NativeFunction(const NativeFunction&) = delete;
+  NativeFunction& operator=(const NativeFunction&) = delete;
+
+  int64_t Invoke(int64_t* slots) const;
+  uint32_t FrameSize() const { return frameSize_; }
+  const std::vector<uint32_t>& Globals() const { return globals_; }
+
+ private:
+  void* memory_;
+  size_t size_;
+  uint32_t frameSize_;
+  std::vector<uint32_t> globals_;
+};
+
+/**
+ * @class JitCompiler
+ * @brief Template JIT translating the bytecode of one function to x86-64
+ *
+ * Every instruction is replaced by a fixed machine code template that keeps
+ * the operand stack on the native stack; jumps are patched once all
+ * templates are placed. The code is written to fresh anonymous pages which
+ * are made executable (and read-only) before use.
+ *
+ * Only integer leaf functions are handled: the body may use integer
+ * constants, frame slots, globals, +, -, *, <, > and jumps inside the
+ * function. Every frame slot must be assigned before it is read and the
+ * operand stack must never underflow. Anything else makes Compile() return
+ * nullptr and the function stays interpreted.
+ */
+class JitCompiler {
+ public:
+  JitCompiler(const Program& program, uint32_t function);
+  std::unique_ptr<NativeFunction> Compile();
+
+ private:
+  const Program& program_;
+  const FunctionInfo& function_;
+  uint32_t end_ = 0;
+  std::vector<uint8_t> code_;
+  std::map<uint32_t, uint32_t> globalSlots_;
+  std::vector<uint32_t> globals_;
+  std::vector<std::pair<size_t, uint32_t>> jumpFixups_;
+
+  bool FindEnd();
+  bool IsSupported() const;
+  bool Verify() const;
+  void EmitInstruction(const Instruction& instruction);
+  uint32_t GlobalSlot(uint32_t global);
+  void EmitBytes(std::initializer_list<uint8_t> bytes);
+  void EmitJump(std::initializer_list<uint8_t> opcode, uint32_t target);
+  void Emit32(uint32_t value);
+  void Emit64(uint64_t value);
+  std::unique_ptr<NativeFunction> Install() const;
+};
+
+#endif  // BACKEND_JIT_H
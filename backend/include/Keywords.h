@@ -0,0 +1,140 @@
+#ifndef BACKEND_KEYWORDS_H
+#define BACKEND_KEYWORDS_H
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+/**
+ * @file Keywords.h
+ * @brief Built-in keyword set, resolved with a perfect hash computed at
+ * compile time
+ *
+ * kDefaultKeywords mirrors tests/workword. The seed of the hash is searched
+ * by the compiler so that every keyword lands in its own slot of
+ * kKeywordTable; a lookup is one hash, one table load and one comparison,
+ * and nothing is read from disk or allocated at startup.
+ */
+
+inline constexpr std::string_view kDefaultKeywords[] = {
+    "bool",     "int",    "float", "char",  "string", "void",
+    "return",   "for",    "def",   "while", "else",   "do",
+    "break",    "continue", "if",  "print", "true",   "false",
+    "len",      "and",    "or",    "not",   "in",     "range"};
+
+inline constexpr size_t kKeywordCount =
+    sizeof(kDefaultKeywords) / sizeof(kDefaultKeywords[0]);
+inline constexpr size_t kKeywordTableSize = 64;
+
+/**
+ * @enum Keyword
+ * @brief Interned id of a built-in keyword: its index in kDefaultKeywords
+ *
+ * Keep in the order of kDefaultKeywords. None marks a lexem that is not one
+ * of the built-in keywords.
+ */
+enum class Keyword : int8_t {
+  None = -1,
+  Bool,
+  Int,
+  Float,
+  Char,
+  String,
+  Void,
+  Return,
+  For,
+  Def,
+  While,
+  Else,
+  Do,
+  Break,
+  Continue,
+  If,
+  Print,
+  True,
+  False,
+  Len,
+  And,
+  Or,
+  Not,
+  In,
+  Range
+};
+
+static_assert(static_cast<size_t>(Keyword::Range) + 1 == kKeywordCount,
+              "Keyword must list every default keyword");
+
+static_assert(kKeywordCount < kKeywordTableSize,
+              "Keyword table must have a free slot");
+
+/**
+ * @brief FNV-1a hash of a word, perturbed by a seed
+ */
+constexpr uint32_t KeywordHash(std::string_view word, uint32_t seed) {
+  uint32_t hash = 2166136261u ^ seed;
+  for (char c : word) {
+    hash = (hash ^ static_cast<unsigned char>(c)) * 16777619u;
+  }
+  return hash ^ (hash >> 15);
+}
+
+/**
+ * @brief Returns the smallest seed that hashes every default keyword to a
+ * distinct slot
+ */
+constexpr uint32_t FindKeywordSeed() {
+  for (uint32_t seed = 0;; ++seed) {
+    std::array<bool, kKeywordTableSize> used{};
+    bool collision = false;
+    for (size_t i = 0; i < kKeywordCount && !collision; ++i) {
+      size_t slot =
+          KeywordHash(kDefaultKeywords[i], seed) % kKeywordTableSize;
+      collision = used[slot];
+      used[slot] = true;
+    }
+    if (!collision) {
+      return seed;
+    }
+  }
+}
+
+inline constexpr uint32_t kKeywordSeed = FindKeywordSeed();
+
+/**
+ * @brief Builds the slot table: keyword id per slot, -1 for empty slots
+ */
+constexpr std::array<int8_t, kKeywordTableSize> BuildKeywordTable() {
+  std::array<int8_t, kKeywordTableSize> table{};
+  for (auto& slot : table) {
+    slot = -1;
+  }
+  for (size_t i = 0; i < kKeywordCount; ++i) {
+    table[KeywordHash(kDefaultKeywords[i], kKeywordSeed) %
+          kKeywordTableSize] = static_cast<int8_t>(i);
+  }
+  return table;
+}
+
+inline constexpr std::array<int8_t, kKeywordTableSize> kKeywordTable =
+    BuildKeywordTable();
+
+/**
+ * @brief Looks a word up in the built-in keyword set
+ *
+ * @return int Index into kDefaultKeywords, or -1 if the word is not a
+ *         keyword
+ */
+constexpr int FindDefaultKeyword(std::string_view word) {
+  int id = kKeywordTable[KeywordHash(word, kKeywordSeed) % kKeywordTableSize];
+  return id >= 0 && kDefaultKeywords[id] == word ? id : -1;
+}
+
+static_assert(FindDefaultKeyword("while") ==
+                      static_cast<int>(Keyword::While) &&
+                  FindDefaultKeyword("whilst") < 0,
+              "Keyword table is inconsistent");
+
+#endif  // BACKEND_KEYWORDS_H
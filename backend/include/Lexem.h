@@ -24,12 +24,22 @@
  *
  * This class stores information about a lexical token including its type,
  * text content, position in source code, and line number.
+ *
+ * Besides the type, a lexem carries an interned id that the analyzers
+ * compare instead of its text: the Keyword of a KEYWORD lexem, the Symbol
+ * of an operator or bracket and the SymbolId of an IDENTIFIER (see
+ * Interner.h). They are computed once, when the lexem is constructed.
+ *
+ * The text is a view, not a copy: it points into the source buffer given to
+ * LexemAnalyzer, or at a string literal for tokens that do not appear
+ * verbatim in the source (NEWLINE, INDENT, DEDENT, EOC). The source buffer
+ * must outlive every Lexem produced from it.
  */
 
 /**
  * @brief Constructs a new Lexem object
  * @param type The type of the lexical token
- * @param text The actual text content of the token
+ * @param text View of the text content of the token
  * @param s Starting position in the source code
  * @param e Ending position in the source code
  * @param l Line number where the token appears
@@ -41,13 +51,33 @@
  */
 
 /**
- * @brief Get the type of the token as string
+ * @brief Get the type of the token
+ * @return LexemType Type of the token
+ */
+
+/**
+ * @brief Get the type of the token as string, for diagnostics
  * @return std::string String representation of token type
  */
 
+/**
+ * @brief Get the keyword id of the token
+ * @return Keyword The built-in keyword, Keyword::None for other tokens
+ */
+
+/**
+ * @brief Get the operator or bracket id of the token
+ * @return Symbol The symbol, Symbol::None for other tokens
+ */
+
+/**
+ * @brief Get the interned id of an identifier
+ * @return SymbolId The id of the name, kNoSymbol for other tokens
+ */
+
 /**
  * @brief Get the text content of the token
- * @return std::string The actual text of the token
+ * @return std::string_view The actual text of the token
  */
 
 /**
@@ -62,9 +92,14 @@
 
 /**
  * @brief Set the text content of the token
- * @param text New text content to set
+ * @param text New text content to set; it must outlive the token
  */
+#include <cstdint>
 #include <iostream>
+#include <string>
+#include <string_view>
+#include "Interner.h"
+#include "Keywords.h"
 
 #ifndef BACKEND_LEXEM_H
 #define BACKEND_LEXEM_H
@@ -86,23 +121,64 @@ enum LexemType {
   EOC
 };
 
+/**
+ * @enum Symbol
+ * @brief Interned id of an operator, relational operator or bracket
+ */
+enum class Symbol : uint8_t {
+  None,
+  LeftParen,
+  RightParen,
+  LeftBrace,
+  RightBrace,
+  LeftBracket,
+  RightBracket,
+  Comma,
+  Semicolon,
+  Colon,
+  Assign,
+  Plus,
+  Minus,
+  Star,
+  Slash,
+  Percent,
+  Less,
+  Greater,
+  Equal,
+  NotEqual,
+  LessEqual,
+  GreaterEqual,
+  Not,
+  And,
+  Or
+};
+
+Symbol FindSymbol(std::string_view text);
+
 class Lexem {
  public:
-  Lexem(LexemType type, std::string text, int s, int e, int l)
-      : type_(type), text_(text), s_(s), e_(e), line_(l){};
+  Lexem(LexemType type, std::string_view text, int s, int e, int l);
   // Getters
   size_t get_line() const;
-  std::string get_type() const;
-  std::string get_text() const;
+  LexemType get_type() const { return type_; }
+  std::string get_type_name() const;
+  Keyword get_keyword() const { return keyword_; }
+  Symbol get_symbol() const { return symbol_; }
+  SymbolId get_id() const { return id_; }
+  std::string_view get_text() const;
   size_t get_start() const;
   size_t get_end() const;
   // Setters
-  void set_text(std::string text);
+  void set_text(std::string_view text);
+  void relocate(std::string_view text, int offset, int lines);
 
  private:
   int s_, e_;
   LexemType type_;
-  std::string text_;
+  SymbolId id_ = kNoSymbol;
+  Keyword keyword_ = Keyword::None;
+  Symbol symbol_ = Symbol::None;
+  std::string_view text_;
   size_t line_;
 };
 
@@ -1,10 +1,15 @@
 #ifndef LEXEM_ANALYZER_H
 #define LEXEM_ANALYZER_H
 
+#include <cstddef>
+#include <memory>
 #include <string>
+#include <string_view>
 #include <vector>
 #include "Bor.h"
+#include "Keywords.h"
 #include "Lexem.h"
+#include "Scan.h"
 
 /**
  * @class LexemAnalyzer
@@ -23,8 +28,33 @@
  * - String and number literals
  * - Indentation-based scope management
  *
- * @param code The source code to be analyzed
- * @param pathToKeywords Path to the file containing language keywords
+ * Identifiers, numbers, whitespace runs, indentation and string literals are
+ * consumed as whole spans found by the kernels in Scan.h rather than one
+ * character at a time.
+ *
+ * After Analyze() the analyzer keeps a checkpoint at every top-level
+ * statement, so Reanalyze() can lex an edited source again starting from the
+ * last checkpoint before the edit, and stop as soon as it reaches a
+ * checkpoint after the edit with the same indentation stack; the lexems
+ * behind that point are kept from the previous run and only shifted to
+ * their new offsets and lines.
+ *
+ * Instead of lexing everything up front, the lexems can be pulled one at a
+ * time with Next() and Peek(): the analyzer then lexes one top-level
+ * statement whenever its buffer runs out and drops the lexems already
+ * pulled, so memory does not grow with the size of the source and an error
+ * in a consumer stops lexing early. After Analyze() the same calls walk the
+ * complete lexems instead.
+ *
+ * AnalyzeParallel() splits a large source before top-level "def" lines and
+ * lexes the parts on separate threads, each from a fresh indentation stack.
+ * The parts are joined where lexing of one part reaches a checkpoint of
+ * the next, so the result is always the same as that of Analyze().
+ *
+ * @param code The source code to be analyzed; the lexems keep views into it,
+ * so it must outlive them
+ * @param pathToKeywords Path to a file with a custom keyword set; the
+ * built-in keywords from Keywords.h are used when it is empty
  */
 /**
  * @file LexemAnalyzer.h
@@ -45,17 +75,52 @@
  */
 class LexemAnalyzer {
  public:
-  LexemAnalyzer(const std::string& code, const std::string& pathToKeywords);
+  LexemAnalyzer(std::string_view code,
+                const std::string& pathToKeywords = "");
+  LexemAnalyzer(std::string_view code, std::shared_ptr<const bor> keywords);
+  static std::shared_ptr<const bor> LoadKeywords(const std::string& path);
   void Analyze();
+  void AnalyzeParallel(unsigned threads);
+  void Reanalyze(std::string_view code, size_t begin, size_t removed,
+                 size_t inserted);
   void PrintLexems() const;
 
   size_t GetCurrentPosition() const { return currentPosition_; }
 
-  std::vector<Lexem> GetLexems() { return lexems_; }
+  const std::vector<Lexem>& GetLexems() const { return lexems_; }
+
+  const Lexem& Peek(size_t ahead = 0);
+  Lexem Next();
 
  private:
+  /**
+   * @brief State of the analyzer where the top-level loop starts a statement
+   */
+  struct Checkpoint {
+    size_t offset;       // Position() of the current character
+    size_t lexem;        // number of lexems emitted before it
+    size_t line;         // curLine_
+    size_t indentBegin;  // first level of indentStack_ in checkpointIndents_
+    size_t indentDepth;  // size of indentStack_
+  };
+
+  /**
+   * @brief Checkpoints of another run that lexing may rejoin
+   *
+   * Used by Reanalyze() with the previous run of the same analyzer and by
+   * AnalyzeParallel() with the run of the next part.
+   */
+  struct Resync {
+    const LexemAnalyzer* run;  // analyzer holding the checkpoints
+    size_t first;              // first checkpoint that may match
+    size_t checkpoints;        // end of the checkpoints that may match
+    size_t end;   // no checkpoint matches before this offset of our source
+    long delta;   // our offset minus the offset in the other run's source
+    size_t match;  // checkpoint lexing stopped at, checkpoints if none
+  };
+
   // Parsing func
-  void AnalyzeProgram();
+  bool AnalyzeProgram(Resync* resync = nullptr);
   void AnalyzeStatement();
   void AnalyzeVariableDeclaration();
   void AnalyzeFunctionDeclaration();
@@ -70,6 +135,7 @@ class LexemAnalyzer {
   void AnalyzeArrayDeclaration();
   void AnalyzeExpression();
   void AnalyzeIdentifier();
+  void AnalyzeOperator();
   void AnalyzeNumber();
   void AnalyzeString();
   void AnalyzeTerm();
@@ -79,16 +145,35 @@ class LexemAnalyzer {
   void GetNextChar();
   void SkipWhitespace();
   void HandleIndentation(int previousIndentation);
+  bool IsKeyword(std::string_view word) const;
+  std::string_view ScanWord();
+  size_t Position() const;
+  void SkipTo(size_t position);
+  void Reset();
+  void LexStatement();
+  std::vector<size_t> SplitAtTopLevel(unsigned parts) const;
+  void AnalyzePart(size_t begin, size_t end, size_t line);
+  void AppendPart(LexemAnalyzer& part, size_t from);
+  void SaveCheckpoint();
+  bool Resynchronize(Resync& resync);
+  std::string_view Rebase(std::string_view text, std::string_view from,
+                          long delta) const;
 
   // var
   char ch_;
-  std::string code_;
+  std::string_view code_;
   std::vector<Lexem> lexems_;
   std::vector<int> indentStack_;
+  std::vector<Checkpoint> checkpoints_;
+  std::vector<int> checkpointIndents_;
   size_t index_;
   size_t currentPosition_;
-  bor keywords_;
+  std::shared_ptr<const bor> keywords_;
   size_t curLine_ = 0;
+  size_t stop_ = std::string_view::npos;
+  size_t pulled_ = 0;
+  bool lexedAll_ = false;
+  const ScanKernels& scan_;
 };
 
 #endif  // LEXEM_ANALYZER_H
\ No newline at end of file
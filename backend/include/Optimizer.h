@@ -0,0 +1,65 @@
+#ifndef BACKEND_OPTIMIZER_H
+#define BACKEND_OPTIMIZER_H
+
+#pragma once
+
+#include <cell.h>
+#include <cstddef>
+#include <set>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Counters reported by Optimizer::Run()
+ */
+struct OptimizerStats {
+  size_t cellsBefore = 0;
+  size_t cellsAfter = 0;
+  size_t foldedOperators = 0;
+  size_t threadedJumps = 0;
+
+  size_t RemovedCells() const { return cellsBefore - cellsAfter; }
+};
+
+/**
+ * @class Optimizer
+ * @brief Rewrites the cells produced by RPN::buildRPN() before they are
+ * compiled
+ *
+ * Level 0 returns the cells unchanged. Level 1 runs, until nothing
+ * changes:
+ * - constant folding: an operator cell whose operands are all Const cells
+ *   is evaluated and replaces them (2 3 * becomes 6); operations that
+ *   would fail at run time are left for the interpreter to report
+ * - jump threading: a jump to a label followed by an unconditional GoTo
+ *   goes straight to that GoTo's target, and a GoTo to the label right
+ *   after it is dropped
+ * - dead-code elimination: cells after a ReturnCell or an unconditional
+ *   GoToCell are removed up to the next referenced label or definition,
+ *   and labels no jump refers to are dropped
+ *
+ * Jump targets are absolute cell indices and are remapped after every
+ * removal.
+ */
+class Optimizer {
+ public:
+  Optimizer(const std::vector<RPNCell>& rpn);
+  std::vector<RPNCell> Run(int level);
+  const OptimizerStats& Stats() const { return stats_; }
+
+ private:
+  std::vector<RPNCell> rpn_;
+  OptimizerStats stats_;
+
+  bool FoldConstants();
+  bool ThreadJumps();
+  bool EliminateDeadCode();
+  void RemoveCells(const std::vector<bool>& removed);
+  std::set<size_t> ReferencedCells() const;
+  bool IsJump(size_t index) const;
+  bool IsUnconditionalJump(size_t index) const;
+  bool IsFunctionLabel(size_t index) const;
+  size_t Target(size_t index) const;
+};
+
+#endif  // BACKEND_OPTIMIZER_H
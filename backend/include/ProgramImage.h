@@ -0,0 +1,53 @@
+#ifndef BACKEND_PROGRAMIMAGE_H
+#define BACKEND_PROGRAMIMAGE_H
+
+#pragma once
+
+#include <cell.h>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "SourceBuffer.h"
+
+/**
+ * @class ProgramImage
+ * @brief Precompiled RPN program in a binary file (.usc) that is mapped
+ * into memory and run without lexing or parsing its source
+ *
+ * The image starts with a fixed header: the magic "SIGMAUSC", the format
+ * version, a byte-order mark and the offset and length of each section.
+ * Every reference inside the image is an offset or an index, never an
+ * address, so the file can be mapped anywhere and shipped as is to other
+ * hosts of the same byte order. The sections are:
+ * - cells: one 12-byte record per cell: type, op, a flag telling whether
+ *   it names a symbol, arity and an operand, which is an index into the
+ *   constant pool for a Const cell, into the label table for a Label
+ *   cell, the target cell for a jump and into the symbol table otherwise
+ * - constant pool: the literals of the Const cells, each stored once
+ * - symbol table: the names and operator spellings of the other cells,
+ *   each stored once; the names are interned when the image is loaded
+ * - label table: the name of each label and the cell it marks
+ * - string pool: the bytes of all the strings the tables refer to
+ *
+ * Loading checks every offset and index against the bounds of the image,
+ * so a truncated or corrupted file is reported instead of run.
+ *
+ * @throws std::runtime_error if the image cannot be read, is of another
+ *         format version or byte order, or is malformed
+ */
+class ProgramImage {
+ public:
+  static constexpr uint32_t kVersion = 1;
+
+  static void Write(const std::vector<RPNCell>& cells,
+                    const std::string& path);
+
+  explicit ProgramImage(const std::string& path);
+  std::vector<RPNCell> Cells() const;
+
+ private:
+  std::string path_;
+  SourceBuffer file_;
+};
+
+#endif  // BACKEND_PROGRAMIMAGE_H
@@ -2,55 +2,60 @@
 #define RPN_H
 
 #include <cell.h>
+#include <cstdint>
 #include <iostream>
-#include <map>
-#include <stack>
 #include <string>
 #include <vector>
-#include "Lexem.h"
+#include "Ast.h"
 
 class RPN {
  public:
-  RPN(const std::vector<Lexem>& lexems);
+  RPN(const Ast& ast);
   void buildRPN();
   void printRPN() const;
+  static void printCells(const std::vector<RPNCell>& cells);
   std::vector<RPNCell> getRPN();
 
  private:
-  std::vector<Lexem> lexems_;
+  // A jump waiting for its target: a label number, or the SymbolId of the
+  // callee for the jump of a call
+  struct Relocation {
+    size_t cell;
+    size_t target;
+    bool call;
+  };
+
+  static constexpr size_t kNoCell = SIZE_MAX;
+
+  const Ast& ast_;
   std::vector<RPNCell> rpn_;
-  std::stack<size_t> FuncCalls;
-  std::map<std::string, int> labels;
-  Lexem curLex_;
-  size_t index_;
+  std::vector<std::string> labelNames_;
+  std::vector<size_t> labelCells_;
+  std::vector<size_t> functionCells_;
+  std::vector<Relocation> relocations_;
+  size_t funcEndLabel_ = kNoCell;
   // analyze functions
-  void AnalyzeLexemsList();
-  void buildFunctionRPN();
-  void buildAssignmentRPN();
-  void buildPrintRPN();
-  void buildIfRPN();
-  void buildWhileRPN();
-  void buildForRPN();
-  void buildFunctionCallRPN();
-  void buildMathOperationRPN(std::string start = "");
-  void buildGoToCellRPN();
-  void buildReturnCellRPN();
-  void buildCallCeilRPN();
-  void buildConditionalJumpCellRPN();
-  void buildLabelCellRPN();
+  void buildBlockRPN(const Block& block);
+  void buildStatementRPN(const Statement& statement);
+  void buildFunctionRPN(const FunctionNode& node);
+  void buildDeclarationRPN(const DeclarationNode& node);
+  void buildAssignmentRPN(const AssignmentNode& node);
+  void buildCallRPN(const CallNode& node);
+  void buildPrintRPN(const PrintNode& node);
+  void buildIfRPN(const IfNode& node);
+  void buildWhileRPN(const WhileNode& node);
+  void buildForRPN(const ForNode& node);
+  void buildReturnCellRPN(const ReturnNode& node);
+  void buildMathOperationRPN(const Expression& expression);
+  size_t buildExpressionRPN(const Span<Lexem>& tokens, size_t pos,
+                            int minPrecedence);
+  size_t buildUnaryRPN(const Span<Lexem>& tokens, size_t pos);
+  size_t buildOperandRPN(const Span<Lexem>& tokens, size_t pos);
   void buildRPNCell(const RPNCell& cell);
-  // helper functions
-  void getLexem();
-  int getPrecedence(const std::string& op) const;
-  bool isOperator(const std::string& token) const;
-  bool isRelOp(const std::string& token) const;
-  bool isMathOp(const std::string& token) const;
-  bool isGoToCell(const std::string& token) const;
-  bool isReturnCell(const std::string& token) const;
-  bool isCallCeil(const std::string& token) const;
-  bool isConditionalJumpCell(const std::string& token) const;
-  bool isLabelCell(const std::string& token) const;
-  bool isNumber(const std::string& token) const;
+  void buildJumpRPN(CellType type, size_t label);
+  void placeLabel(size_t label);
+  size_t newLabel(const std::string& kind);
+  void resolveLabels();
 };
 
 #endif  // RPN_H
\ No newline at end of file
@@ -0,0 +1,151 @@
+#ifndef BACKEND_REGISTERCODE_H
+#define BACKEND_REGISTERCODE_H
+
+#pragma once
+
+#include <cstdint>
+#include <set>
+#include <string>
+#include <vector>
+#include "Bytecode.h"
+#include "Value.h"
+
+/**
+ * @enum RegOpCode
+ * @brief Three-address operations executed by the RegisterMachine
+ *
+ * - Move: a = b
+ * - Add..Or: a = b op c
+ * - Not, Negate: a = op b
+ * - Jump/JumpIfFalse: continue at instruction a (JumpIfFalse tests b)
+ * - Call: enter functions[a], its arguments are the consecutive registers
+ *   starting at register b of the caller
+ * - Leave: leave the function
+ * - Print: print b, or an empty line when b is None
+ */
+enum class RegOpCode : uint8_t {
+  Move,
+  Add,
+  Sub,
+  Mul,
+  Div,
+  Mod,
+  Less,
+  Greater,
+  LessEqual,
+  GreaterEqual,
+  Equal,
+  NotEqual,
+  And,
+  Or,
+  Not,
+  Negate,
+  Jump,
+  JumpIfFalse,
+  Call,
+  Leave,
+  Print
+};
+
+/**
+ * @enum OperandKind
+ * @brief What the 14-bit index of an operand refers to
+ *
+ * Registers are relative to the current frame, constants index the pool
+ * and globals the global slots, so most statements need no separate load
+ * or store instruction.
+ */
+enum class OperandKind : uint8_t { Register, Constant, Global, None };
+
+/**
+ * @brief A single three-address instruction: 8-bit opcode, 24-bit
+ * destination or target and two 16-bit source operands
+ */
+struct RegInstruction {
+  RegOpCode op : 8;
+  uint32_t a : 24;
+  uint16_t b;
+  uint16_t c;
+};
+
+static_assert(sizeof(RegInstruction) == 8, "RegInstruction must stay 8 bytes");
+
+const uint32_t kOperandIndexBits = 14;
+const uint32_t kMaxOperandIndex = (1u << kOperandIndexBits) - 1;
+
+inline uint16_t MakeOperand(OperandKind kind, uint32_t index) {
+  return static_cast<uint16_t>(
+      (static_cast<uint32_t>(kind) << kOperandIndexBits) | index);
+}
+
+inline OperandKind KindOf(uint32_t operand) {
+  return static_cast<OperandKind>(operand >> kOperandIndexBits);
+}
+
+inline uint32_t IndexOf(uint32_t operand) {
+  return operand & kMaxOperandIndex;
+}
+
+/**
+ * @brief A program lowered for the RegisterMachine
+ *
+ * FunctionInfo::entry indexes code and FunctionInfo::frameSize is the size
+ * of the register file of the function: its locals first, then the
+ * temporaries of its expressions. mainRegisters sizes the register file of
+ * the top-level code.
+ */
+struct RegisterProgram {
+  std::vector<RegInstruction> code;
+  std::vector<Value> constants;
+  std::vector<std::string> globalNames;
+  std::vector<FunctionInfo> functions;
+  uint32_t mainRegisters = 0;
+};
+
+/**
+ * @class RegisterCompiler
+ * @brief Lowers a stack Program into three-address register code
+ *
+ * The operand stack is simulated at compile time: loads and constants only
+ * push an operand, operators read their operands directly and write a
+ * temporary register chosen by stack depth, and a store retargets the
+ * instruction that produced its value. `total = total + j * 2` becomes two
+ * instructions instead of six. The symbolic stack is written back to its
+ * temporaries before every jump, call and jump target, so blocks agree on
+ * where values live.
+ *
+ * @throws std::runtime_error if an index does not fit in an operand
+ */
+class RegisterCompiler {
+ public:
+  RegisterCompiler(const Program& program);
+  RegisterProgram Compile();
+
+ private:
+  const Program& program_;
+  RegisterProgram lowered_;
+  std::vector<int> owner_;
+  std::set<uint32_t> targets_;
+  std::vector<uint32_t> stackToRegister_;
+  std::vector<std::pair<uint32_t, uint32_t>> jumpFixups_;
+  std::vector<uint16_t> stack_;
+  std::vector<uint16_t> pending_;
+  uint32_t base_ = 0;
+  uint32_t maxDepth_ = 0;
+  int lastDefined_ = -1;
+
+  void FindOwners();
+  void EnterRegion(int function);
+  void LeaveRegion(int function);
+  void Flush();
+  void Materialize(size_t depth);
+  void Push(uint16_t operand);
+  uint16_t Pop();
+  uint16_t Temporary(size_t depth);
+  void Store(uint16_t destination);
+  void Binary(RegOpCode op);
+  void Unary(RegOpCode op);
+  void Emit(RegOpCode op, uint32_t a = 0, uint16_t b = 0, uint16_t c = 0);
+};
+
+#endif  // BACKEND_REGISTERCODE_H
@@ -0,0 +1,52 @@
+#ifndef BACKEND_REGISTERMACHINE_H
+#define BACKEND_REGISTERMACHINE_H
+
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+#include "RegisterCode.h"
+#include "Value.h"
+
+/**
+ * @class RegisterMachine
+ * @brief Executes a RegisterProgram produced by RegisterCompiler
+ *
+ * Every frame owns a fixed window of one contiguous register array, sized
+ * by FunctionInfo::frameSize (RegisterProgram::mainRegisters for the top
+ * level code). Instructions read constants, globals and registers of the
+ * current window directly, there is no operand stack.
+ *
+ * @throws std::runtime_error on undefined variables, type errors and
+ *         division by zero
+ */
+class RegisterMachine {
+ public:
+  RegisterMachine(const RegisterProgram& program);
+  void Run();
+
+ private:
+  struct Frame {
+    uint32_t returnAddress;
+    uint32_t callerBase;
+    uint32_t function;
+  };
+
+  const RegisterProgram& program_;
+  std::vector<std::optional<Value>> registers_;
+  std::vector<std::optional<Value>> globals_;
+  std::vector<Frame> frames_;
+  uint32_t base_ = 0;
+  uint32_t pc_ = 0;
+
+  const Value& Read(uint32_t operand) const;
+  void Write(uint32_t operand, Value value);
+  void Binary(const RegInstruction& instruction, Operator op);
+  void Unary(const RegInstruction& instruction, Operator op);
+  void Call(uint32_t function, uint32_t arguments);
+  void Leave();
+  void Print(uint32_t operand);
+};
+
+#endif  // BACKEND_REGISTERMACHINE_H
@@ -0,0 +1,57 @@
+#ifndef BACKEND_SCAN_H
+#define BACKEND_SCAN_H
+
+#pragma once
+
+#include <cstddef>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define SIGMA_HAS_SIMD_SCAN 1
+#else
+#define SIGMA_HAS_SIMD_SCAN 0
+#endif
+
+/**
+ * @file Scan.h
+ * @brief Span kernels used by LexemAnalyzer to skip runs of characters of
+ * one class in a single call
+ *
+ * Every kernel takes the source, the position of the first character of a
+ * run and the end of the source, and returns the position of the first
+ * character that does not belong to the run (or the end). On x86-64 the
+ * kernels test 16 (SSE2) or 32 (AVX2) bytes per step; the widest set the
+ * CPU supports is picked at runtime with CPUID and the scalar kernels are
+ * used everywhere else.
+ *
+ * Character classes are plain ASCII, bytes above 127 belong to none:
+ * - identifier: letters, digits and '_'
+ * - digits: '0'..'9'
+ * - blanks: whitespace other than '\n'
+ * - spaces: ' ' only, used to measure indentation
+ * - quote: anything but '"', i.e. the body of a string literal
+ */
+
+/**
+ * @enum ScanIsa
+ * @brief Instruction set a kernel set is written for
+ */
+enum class ScanIsa { Scalar, Sse2, Avx2 };
+
+/**
+ * @brief One kernel per character class
+ */
+struct ScanKernels {
+  ScanIsa isa;
+  size_t (*identifier)(const char* data, size_t begin, size_t end);
+  size_t (*digits)(const char* data, size_t begin, size_t end);
+  size_t (*blanks)(const char* data, size_t begin, size_t end);
+  size_t (*spaces)(const char* data, size_t begin, size_t end);
+  size_t (*quote)(const char* data, size_t begin, size_t end);
+};
+
+ScanIsa DetectScanIsa();
+ScanIsa UseScanIsa(ScanIsa isa);
+const ScanKernels& ActiveScanKernels();
+const char* ScanIsaName(ScanIsa isa);
+
+#endif  // BACKEND_SCAN_H
@@ -0,0 +1,61 @@
+#ifndef BACKEND_SCOPETABLE_H
+#define BACKEND_SCOPETABLE_H
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+#include "Ast.h"
+#include "Interner.h"
+
+/**
+ * @class ScopeTable
+ * @brief Variables visible at the current point of a program, with the
+ * nested scopes they were declared in
+ *
+ * All scopes share one open-addressing hash table keyed by SymbolId. A slot
+ * points at the innermost binding of its name, and every binding points at
+ * the one it shadows, so a lookup is one probe sequence whatever the depth
+ * of nesting. Bindings are appended to a single vector that doubles as the
+ * undo log: ExitScope() pops the bindings made since the matching
+ * EnterScope() and puts back the ones they shadowed. Each declaration is
+ * therefore paid for once when it is made and once when its scope ends.
+ *
+ * The table is sized to the names of the program rather than indexed by
+ * id, since ids are shared by every program compiled in the process.
+ */
+class ScopeTable {
+ public:
+  ScopeTable();
+
+  void EnterScope();
+  void ExitScope();
+  void Define(SymbolId name, ValueType type);
+  std::optional<ValueType> Find(SymbolId name) const;
+
+ private:
+  static constexpr uint32_t kNone = UINT32_MAX;
+
+  struct Slot {
+    SymbolId name = kNoSymbol;
+    uint32_t binding = kNone;
+  };
+
+  struct Binding {
+    SymbolId name;
+    ValueType type;
+    uint32_t shadowed;
+  };
+
+  std::vector<Slot> slots_;
+  std::vector<Binding> bindings_;
+  std::vector<size_t> scopes_;
+  size_t names_ = 0;
+
+  size_t SlotOf(SymbolId name) const;
+  void Grow();
+};
+
+#endif  // BACKEND_SCOPETABLE_H
@@ -1,28 +1,36 @@
 #pragma once
 
 #include <map>
+#include <optional>
 #include <stdexcept>
 #include <string>
 #include <vector>
-#include "Lexem.h"
+#include "Ast.h"
+#include "ScopeTable.h"
 
 /**
  * @class SemanticAnalyzer
- * @brief Analyzes the semantics of a given set of lexems.
+ * @brief Analyzes the semantics of the syntax tree of a program.
  *
  * The SemanticAnalyzer class is responsible for performing semantic analysis
- * on a vector of lexems. It checks for correct usage of variables, functions,
- * and other language constructs within the provided lexems.
- *
- * @var curLex_ The current lexem being analyzed.
- * @var index The current index in the lexem vector.
- * @var lexems_ The vector of lexems to be analyzed.
- * @var scopeStack_ A stack of scopes, each represented by a map of variable names to their types.
- * @var functionSignatures_ A map of function names to their parameter types.
- *
- * @fn SemanticAnalyzer(std::vector<Lexem>& lexems)
- * @brief Constructs a SemanticAnalyzer with the given vector of lexems.
- * @param lexems A vector of lexems to be analyzed.
+ * on the Ast built by SyntaxAnalyzer. It checks for correct usage of
+ * variables, functions, and other language constructs, and annotates the
+ * nodes in place: every Expression gets the type of its value and every
+ * AssignmentNode the declared type of its target.
+ *
+ * @var ast_ The tree to be analyzed.
+ * @var scopes_ The variables visible at the current point and the scopes
+ * they were declared in.
+ * @var functionSignatures_ A map of function ids to their parameter types.
+ * @var variableTypes_ Declared type of every variable, per function
+ * (kNoSymbol for the top level); kept after the scopes are closed.
+ * @var currentFunction_ Id of the function being analyzed, kNoSymbol at top
+ * level.
+ *
+ * @fn SemanticAnalyzer(Ast& ast)
+ * @brief Constructs a SemanticAnalyzer for the given tree.
+ * @param ast The tree to be analyzed and annotated; it must outlive the
+ * analyzer.
  *
  * @fn void Analyze()
  * @brief Starts the semantic analysis process.
@@ -30,92 +38,94 @@
  * @fn void PrintFunction()
  * @brief Prints the function signatures.
  *
- * @fn void GetLexem()
- * @brief Retrieves the next lexem from the vector.
+ * @fn GetVariableTypes()
+ * @brief Returns the declared variable types recorded during Analyze().
+ *
+ * @fn GetFunctionSignatures()
+ * @brief Returns the parameter types of the analyzed functions.
  *
- * @fn void CheckFunctionCall(const std::string& funcName)
+ * @fn void CheckFunctionCall(const CallNode& call)
  * @brief Checks the validity of a function call.
- * @param funcName The name of the function being called.
+ * @param call The call statement.
  *
- * @fn void AnalyzeProgram()
- * @brief Analyzes the entire program.
+ * @fn void AnalyzeBlock(const Block& block)
+ * @brief Analyzes the statements of a block.
  *
- * @fn void AnalyzeStatement()
+ * @fn void AnalyzeStatement(Statement& statement)
  * @brief Analyzes a single statement.
  *
- * @fn void AnalyzeFunction()
+ * @fn void AnalyzeFunction(FunctionNode& node)
  * @brief Analyzes a function definition.
  *
- * @fn void AnalyzeVariableDeclaration()
+ * @fn void AnalyzeVariableDeclaration(DeclarationNode& node)
  * @brief Analyzes a variable declaration.
  *
- * @fn void AnalyzeExpression()
- * @brief Analyzes an expression.
+ * @fn void AnalyzeAssignment(AssignmentNode& node)
+ * @brief Analyzes an assignment to a declared variable.
  *
- * @fn void AnalyzePrint()
+ * @fn void AnalyzeExpression(Expression& expression)
+ * @brief Analyzes an expression and records its type.
+ *
+ * @fn void AnalyzePrint(PrintNode& node)
  * @brief Analyzes a print statement.
  *
- * @fn void AnalyzeWhile()
+ * @fn void AnalyzeWhile(WhileNode& node)
  * @brief Analyzes a while loop.
  *
- * @fn void AnalyzeIf()
+ * @fn void AnalyzeIf(IfNode& node)
  * @brief Analyzes an if statement.
  *
- * @fn void AnalyzeFor()
+ * @fn void AnalyzeFor(ForNode& node)
  * @brief Analyzes a for loop.
  *
- * @fn void EnterScope()
- * @brief Enters a new scope.
- *
- * @fn void ExitScope()
- * @brief Exits the current scope.
- *
- * @fn bool IsVarDefined(const std::string &var)
- * @brief Checks if a variable is defined in the current scope.
- * @param var The name of the variable.
- * @return True if the variable is defined, false otherwise.
+ * @fn std::optional<ValueType> FindVariable(SymbolId var)
+ * @brief Gets the type of a variable visible in the current scope.
+ * @param var The id of the variable.
+ * @return The type of the variable, nothing if it is not defined.
  *
- * @fn std::string GetVarType(const std::string &var)
- * @brief Gets the type of a variable.
- * @param var The name of the variable.
- * @return The type of the variable.
+ * @fn ValueType OperandType(const Lexem& operand)
+ * @brief Gets the type of a literal or variable operand.
+ * @param operand The lexem of the operand.
+ * @return The type, ValueType::Unknown for any other lexem.
  *
- * @fn void AddVariable(const std::string &var, const std::string &type)
+ * @fn void AddVariable(SymbolId var, ValueType type)
  * @brief Adds a variable to the current scope.
- * @param var The name of the variable.
+ * @param var The id of the variable.
  * @param type The type of the variable.
  */
 class SemanticAnalyzer {
  public:
-  SemanticAnalyzer(std::vector<Lexem>& lexems);
+  SemanticAnalyzer(Ast& ast);
   void Analyze();
   void PrintFunction();
+  const std::map<SymbolId, std::map<SymbolId, ValueType>>& GetVariableTypes()
+      const;
+  const std::map<SymbolId, std::vector<ValueType>>& GetFunctionSignatures()
+      const;
 
  private:
   // vars
-  Lexem curLex_;
-  size_t index = 0;
-  std::vector<Lexem> lexems_;
-  std::vector<std::map<std::string, std::string>> scopeStack_;
-  std::map<std::string, std::vector<std::string>> functionSignatures_;
+  Ast& ast_;
+  ScopeTable scopes_;
+  std::map<SymbolId, std::vector<ValueType>> functionSignatures_;
+  std::map<SymbolId, std::map<SymbolId, ValueType>> variableTypes_;
+  SymbolId currentFunction_ = kNoSymbol;
 
   // main analysis functions
-  void GetLexem();
-  void CheckFunctionCall(const std::string& funcName);
-  void AnalyzeProgram();
-  void AnalyzeStatement();
-  void AnalyzeFunction();
-  void AnalyzeVariableDeclaration();
-  void AnalyzeExpression();
-  void AnalyzePrint();
-  void AnalyzeWhile();
-  void AnalyzeIf();
-  void AnalyzeFor();
+  void CheckFunctionCall(const CallNode& call);
+  void AnalyzeBlock(const Block& block);
+  void AnalyzeStatement(Statement& statement);
+  void AnalyzeFunction(FunctionNode& node);
+  void AnalyzeVariableDeclaration(DeclarationNode& node);
+  void AnalyzeAssignment(AssignmentNode& node);
+  void AnalyzeExpression(Expression& expression);
+  void AnalyzePrint(PrintNode& node);
+  void AnalyzeWhile(WhileNode& node);
+  void AnalyzeIf(IfNode& node);
+  void AnalyzeFor(ForNode& node);
 
   // utility functions
-  void EnterScope();
-  void ExitScope();
-  bool IsVarDefined(const std::string& var);
-  std::string GetVarType(const std::string& var);
-  void AddVariable(const std::string& var, const std::string& type);
+  std::optional<ValueType> FindVariable(SymbolId var) const;
+  ValueType OperandType(const Lexem& operand);
+  void AddVariable(SymbolId var, ValueType type);
 };
\ No newline at end of file
@@ -0,0 +1,45 @@
+#ifndef BACKEND_SERVER_H
+#define BACKEND_SERVER_H
+
+#pragma once
+
+#include <string>
+#include "Driver.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#define SIGMA_HAS_SERVE 1
+#else
+#define SIGMA_HAS_SERVE 0
+#endif
+
+/**
+ * @file Server.h
+ * @brief Resident mode of the backend: runs one program per request
+ * without starting a process for it
+ *
+ * The keyword set, the interned names and the scan kernels are set up
+ * once, when the server starts, and stay warm across requests. Requests
+ * are read from standard input, or from the connections accepted on a
+ * Unix domain socket, one connection at a time; a connection may send any
+ * number of requests. Each one is framed by a header line giving the size
+ * of its body in bytes:
+ *
+ *   RUN <bytes>\n<source of the program>
+ *
+ * and is answered with the exit status of the run and what it wrote to
+ * standard output and standard error, byte for byte what a separate
+ * `backend code.us` process would have produced with the same options:
+ *
+ *   DONE <status> <stdout bytes> <stderr bytes>\n<stdout><stderr>
+ *
+ * A malformed header is answered with status 2 and an explanation on
+ * stderr, and ends the session, since the next frame cannot be found.
+ *
+ * Programs run in the server process, so a program that never ends
+ * blocks the server; a client that gives up on a request should restart
+ * the server.
+ */
+
+int Serve(const RunOptions& options, const std::string& socketPath);
+
+#endif  // BACKEND_SERVER_H
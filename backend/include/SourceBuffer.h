@@ -0,0 +1,50 @@
+#ifndef BACKEND_SOURCEBUFFER_H
+#define BACKEND_SOURCEBUFFER_H
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define SIGMA_HAS_MMAP 1
+#else
+#define SIGMA_HAS_MMAP 0
+#endif
+
+/**
+ * @class SourceBuffer
+ * @brief Read-only contents of a program source, lexed in place
+ *
+ * A regular file is mapped into memory, so its bytes are never copied:
+ * View() points straight at the mapping and LexemAnalyzer and its lexems
+ * read from it. Anything that cannot be mapped (pipes, terminals, empty
+ * files, platforms without mmap) is read into an owned buffer instead.
+ * The path "-" reads standard input.
+ *
+ * The buffer must outlive every lexem produced from it.
+ *
+ * @throws std::runtime_error if the source cannot be opened or read
+ */
+class SourceBuffer {
+ public:
+  explicit SourceBuffer(const std::string& path);
+  ~SourceBuffer();
+
+  SourceBuffer(const SourceBuffer&) = delete;
+  SourceBuffer& operator=(const SourceBuffer&) = delete;
+
+  std::string_view View() const { return std::string_view(data_, size_); }
+  bool IsMapped() const { return mapped_; }
+
+ private:
+  const char* data_ = nullptr;
+  size_t size_ = 0;
+  bool mapped_ = false;
+  std::string contents_;
+
+  void ReadAll(int fd, const std::string& path);
+};
+
+#endif  // BACKEND_SOURCEBUFFER_H
@@ -0,0 +1,128 @@
+#ifndef BACKEND_STACKMACHINE_H
+#define BACKEND_STACKMACHINE_H
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <vector>
+#include "Bytecode.h"
+#include "Jit.h"
+#include "Value.h"
+
+#if defined(__GNUC__) || defined(__clang__)
+#define SIGMA_HAS_COMPUTED_GOTO 1
+#else
+#define SIGMA_HAS_COMPUTED_GOTO 0
+#endif
+
+#ifndef SIGMA_THREADED_DISPATCH
+#define SIGMA_THREADED_DISPATCH SIGMA_HAS_COMPUTED_GOTO
+#endif
+
+/**
+ * @enum Dispatch
+ * @brief Strategy used by StackMachine to get from one handler to the next
+ *
+ * - Switch: a central switch over the opcode of every instruction
+ * - Threaded: the program is translated to direct-threaded code (handler
+ *   address + operand per instruction) and every handler jumps straight
+ *   to the next one with a computed goto. Falls back to Switch when the
+ *   compiler lacks computed goto.
+ */
+enum class Dispatch { Switch, Threaded };
+
+/**
+ * @class StackMachine
+ * @brief Executes a Program produced by BytecodeCompiler in-process
+ *
+ * The machine keeps an operand stack of values, a slot per global and one
+ * contiguous array of frame slots: a call reserves FunctionInfo::frameSize
+ * slots, binds the arguments on the operand stack to the first ones and
+ * continues at the entry of the callee. Return and Leave drop the frame
+ * and discard whatever the callee left on the operand stack.
+ *
+ * Run() uses the dispatch strategy selected at build time with the
+ * SIGMA_DISPATCH CMake option, Run(Dispatch) picks one explicitly.
+ *
+ * Every call site has a monomorphic inline cache holding what the call
+ * needs: callee, entry, arity, frame size and compiled code. It is filled
+ * on the first call and refilled only after the function table changed,
+ * which bumps an epoch shared by all caches.
+ *
+ * Calls are counted per function. Once a function has been called
+ * JitThreshold() times it is handed to JitCompiler; while the compiled code
+ * exists, calls whose arguments and globals are all integers run natively
+ * and every other call keeps being interpreted. A threshold of 0 disables
+ * the JIT.
+ *
+ * @throws std::runtime_error on undefined variables, type errors and
+ *         division by zero
+ */
+class StackMachine {
+ public:
+  StackMachine(const Program& program);
+  void Run();
+  void Run(Dispatch dispatch);
+  void SetJitThreshold(uint32_t threshold);
+  uint32_t JitThreshold() const { return jitThreshold_; }
+
+  static const uint32_t kDefaultJitThreshold = 100;
+
+ private:
+  struct Frame {
+    uint32_t returnAddress;
+    uint32_t stackBase;
+    uint32_t localsBase;
+    uint32_t function;
+  };
+
+  struct InlineCache {
+    uint32_t epoch = 0;
+    uint32_t function = 0;
+    uint32_t entry = 0;
+    uint32_t arity = 0;
+    uint32_t frameSize = 0;
+    bool countCalls = false;
+    const NativeFunction* native = nullptr;
+  };
+
+  const Program& program_;
+  std::vector<Value> stack_;
+  std::vector<std::optional<Value>> globals_;
+  std::vector<std::optional<Value>> locals_;
+  std::vector<Frame> frames_;
+  uint32_t pc_ = 0;
+  uint32_t jitThreshold_ = SIGMA_JIT_ENABLED ? kDefaultJitThreshold : 0;
+  std::vector<uint32_t> callCounts_;
+  std::vector<std::unique_ptr<NativeFunction>> native_;
+  std::vector<bool> jitRejected_;
+  std::vector<int64_t> nativeSlots_;
+  std::vector<InlineCache> inlineCaches_;
+  uint32_t functionTableEpoch_ = 1;
+
+  void Reset();
+  void RunSwitch();
+  void RunThreaded();
+
+  // handlers
+  void PushConst(uint32_t constant);
+  void LoadGlobal(uint32_t slot);
+  void StoreGlobal(uint32_t slot);
+  void LoadLocal(uint32_t slot);
+  void StoreLocal(uint32_t slot);
+  void JumpIfFalse(uint32_t target);
+  void Call(uint32_t site);
+  void ResolveCallSite(uint32_t site);
+  void CompileFunction(uint32_t function);
+  bool CallNative(const NativeFunction& native, uint32_t arity);
+  void Return();
+  void Leave();
+  void Print();
+  void Binary(Operator op);
+  void Unary(Operator op);
+  Value Pop();
+};
+
+#endif  // BACKEND_STACKMACHINE_H
@@ -1,7 +1,9 @@
 #ifndef BACKEND_SYNTAXANALYZER_H
 #define BACKEND_SYNTAXANALYZER_H
 #include <vector>
+#include "Ast.h"
 #include "Lexem.h"
+#include "LexemAnalyzer.h"
 
 /**
  * @brief A syntax analyzer for parsing and validating program syntax
@@ -28,41 +30,51 @@
  * - Return statements
  * - Expressions and assignments
  * 
- * The class maintains internal state tracking current lexeme position during analysis.
+ * The lexemes are pulled from the LexemAnalyzer one at a time as the parser
+ * needs them, so a syntax error is reported before the rest of the source is
+ * lexed. While parsing, the analyzer builds the Ast returned by GetAst(),
+ * which the semantic analysis and the RPN generation walk instead of the
+ * lexemes.
  * 
- * @param lexems Vector of lexemes to be analyzed, passed to constructor
+ * @param lexer Lexical analyzer the lexemes are pulled from
  * 
  * @throws May throw syntax errors if invalid program structure is detected
  */
 class SyntaxAnalyzer {
  public:
-  SyntaxAnalyzer(std::vector<Lexem>& lexems)
-      : lex(lexems), curLex_(lexems[0]) {}
+  explicit SyntaxAnalyzer(LexemAnalyzer& lexer)
+      : lexer_(lexer), curLex_(lexer.Peek()) {}
 
   void Analyze();
+  Ast& GetAst() { return ast_; }
 
  private:
-  std::vector<Lexem> lex;
+  LexemAnalyzer& lexer_;
   Lexem curLex_;
-  int index = 0;
+  bool atEnd_ = false;
+  Ast ast_;
+  std::vector<Lexem> tokens_;
 
   void GetLexem();
   void AnalyzeProgram();
-  void AnalyzeStatement();
-  void AnalyzeVariableDeclaration();
-  void AnalyzeFunctionDeclaration();
-  void AnalyzeParameterList();
-  void AnalyzeIfStatement();
-  void AnalyzeWhileStatement();
-  void AnalyzeForStatement();
-  void AnalyzePrintStatement();
-  void AnalyzeElseStatement();
-  void AnalyzeReturnStatement();
-  bool IsType(const std::string& word);
-  void AnalyzeAssignment();
-  void AnalyzeExpression();
+  Statement* AnalyzeStatement();
+  Statement* AnalyzeVariableDeclaration();
+  Statement* AnalyzeFunctionDeclaration();
+  Span<Parameter> AnalyzeParameterList();
+  Statement* AnalyzeIfStatement();
+  Statement* AnalyzeWhileStatement();
+  Statement* AnalyzeForStatement();
+  Statement* AnalyzePrintStatement();
+  Block AnalyzeElseStatement();
+  Statement* AnalyzeReturnStatement();
+  bool IsType(Keyword keyword);
+  Statement* AnalyzeAssignment();
+  Span<Expression*> AnalyzeArguments();
+  Expression* AnalyzeExpression();
   void AnalyzeStatementTerminator();
-  void AnalyzeBlock();
+  Block AnalyzeBlock();
+  template <typename Node>
+  Node* NewNode();
 };
 
 #endif  //BACKEND_SYNTAXANALYZER_H
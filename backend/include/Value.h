@@ -0,0 +1,77 @@
+#ifndef BACKEND_VALUE_H
+#define BACKEND_VALUE_H
+
+#pragma once
+
+#include <string>
+#include <variant>
+
+/**
+ * @enum Operator
+ * @brief Operators of an expression
+ *
+ * Not and Negate take one operand, Call takes one per argument, the others
+ * take two. Index and Call are compiled into cells but have no runtime
+ * semantics yet: the language has neither array values nor calls that
+ * produce a value.
+ */
+enum class Operator {
+  Add,
+  Sub,
+  Mul,
+  Div,
+  Mod,
+  Less,
+  Greater,
+  LessEqual,
+  GreaterEqual,
+  Equal,
+  NotEqual,
+  And,
+  Or,
+  Not,
+  Negate,
+  Index,
+  Call,
+  Unknown
+};
+
+/**
+ * @class Value
+ * @brief Runtime value manipulated by the StackMachine
+ *
+ * A value is either an integer, a floating point number or a string.
+ * Arithmetic between an int and a float promotes to float, comparison
+ * operators produce the integers 0 and 1.
+ */
+class Value {
+ public:
+  Value() : data_(0LL) {}
+
+  Value(long long v) : data_(v) {}
+
+  Value(double v) : data_(v) {}
+
+  Value(std::string v) : data_(std::move(v)) {}
+
+  bool IsInt() const { return std::holds_alternative<long long>(data_); }
+
+  bool IsFloat() const { return std::holds_alternative<double>(data_); }
+
+  bool IsString() const { return std::holds_alternative<std::string>(data_); }
+
+  long long AsInt() const;
+  double AsFloat() const;
+  const std::string& AsString() const;
+  bool IsTruthy() const;
+  std::string ToString() const;
+
+  static Value FromLiteral(const std::string& literal);
+  static Value Apply(Operator op, const Value& lhs, const Value& rhs);
+  static Value Apply(Operator op, const Value& operand);
+
+ private:
+  std::variant<long long, double, std::string> data_;
+};
+
+#endif  // BACKEND_VALUE_H
@@ -2,6 +2,8 @@
 
 #include <string>
 #include <vector>
+#include "Interner.h"
+#include "Value.h"
 
 enum class CellType {
   GoToCell,
@@ -11,12 +13,27 @@ enum class CellType {
   LabelCell,
   MathCell,
   VarCell,
-  FunctionCell
+  FunctionCell,
+  ConstCell,
+  LoadCell
 };
 
+/**
+ * A Var, Load, Call or user Function cell also carries the interned id of
+ * the name in value, so later passes can index by it instead of hashing
+ * text.
+ *
+ * An expression is a postfix run of cells, one per operand or operator: a
+ * Const cell holds a literal as Value::FromLiteral() reads it, a Load cell
+ * reads a variable, and a Math cell applies op to the arity values before
+ * it. A Math cell whose op is Operator::Unknown is the assignment "=".
+ */
 struct RPNCell {
   CellType type;
   std::string value;
+  SymbolId symbol = kNoSymbol;
+  Operator op = Operator::Unknown;
+  uint32_t arity = 0;
 
   std::string GetTypeAsString() const {
     switch (type) {
@@ -36,10 +53,22 @@ struct RPNCell {
         return "Math";
       case CellType::FunctionCell:
         return "Function";
+      case CellType::ConstCell:
+        return "Const";
+      case CellType::LoadCell:
+        return "Load";
       default:
         return "Unknown";
     }
   }
 
-  RPNCell(CellType t, std::string v) : type(t), value(std::move(v)) {}
+  RPNCell(CellType t, std::string v, SymbolId s = kNoSymbol)
+      : type(t), value(std::move(v)), symbol(s) {}
+
+  RPNCell(Operator o, std::string v, uint32_t n, SymbolId s = kNoSymbol)
+      : type(CellType::MathCell),
+        value(std::move(v)),
+        symbol(s),
+        op(o),
+        arity(n) {}
 };
\ No newline at end of file
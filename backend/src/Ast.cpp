@@ -0,0 +1,68 @@
+#include "Ast.h"
+
+/**
+ * @brief Returns uninitialized memory for an object of the given size.
+ *
+ * @param size Size of the object in bytes
+ * @param align Alignment of the object, a power of two not above
+ *        alignof(std::max_align_t)
+ */
+void* Arena::Allocate(size_t size, size_t align) {
+  size_t padding = -reinterpret_cast<uintptr_t>(cursor_) & (align - 1);
+  if (cursor_ == nullptr || size + padding > size_t(end_ - cursor_)) {
+    size_t blockSize = size > kBlockSize ? size : kBlockSize;
+    blocks_.emplace_back(new char[blockSize]);
+    cursor_ = blocks_.back().get();
+    end_ = cursor_ + blockSize;
+    padding = 0;
+  }
+  void* object = cursor_ + padding;
+  cursor_ += padding + size;
+  used_ += size;
+  return object;
+}
+
+/**
+ * @brief Returns the type named by a type keyword, ValueType::Unknown for
+ * any other text.
+ */
+ValueType FindValueType(std::string_view name) {
+  if (name == "int") {
+    return ValueType::Int;
+  }
+  if (name == "float") {
+    return ValueType::Float;
+  }
+  if (name == "bool") {
+    return ValueType::Bool;
+  }
+  if (name == "char") {
+    return ValueType::Char;
+  }
+  if (name == "string") {
+    return ValueType::String;
+  }
+  if (name == "void") {
+    return ValueType::Void;
+  }
+  return ValueType::Unknown;
+}
+
+const char* ValueTypeName(ValueType type) {
+  switch (type) {
+    case ValueType::Int:
+      return "int";
+    case ValueType::Float:
+      return "float";
+    case ValueType::Bool:
+      return "bool";
+    case ValueType::Char:
+      return "char";
+    case ValueType::String:
+      return "string";
+    case ValueType::Void:
+      return "void";
+    default:
+      return "";
+  }
+}
@@ -0,0 +1,416 @@
+#include "Bytecode.h"
+#include <cctype>
+#include <stdexcept>
+
+namespace {
+
+const uint32_t kMaxOperand = (1u << 24) - 1;
+const uint32_t kNoSlot = UINT32_MAX;
+
+bool IsBuiltin(const std::string& name) {
+  return name == "print";
+}
+
+bool IsLabel(const RPNCell& cell, const std::string& kind) {
+  return cell.type == CellType::LabelCell &&
+         cell.value.compare(0, kind.size() + 1, kind + "_") == 0;
+}
+
+// Id of the name of a cell; cells built by hand may leave it out
+SymbolId SymbolOf(const RPNCell& cell) {
+  return cell.symbol != kNoSymbol ? cell.symbol : InternSymbol(cell.value);
+}
+
+template <typename T>
+void SetAt(std::vector<T>& table, SymbolId name, T value, T missing) {
+  if (table.size() <= name) {
+    table.resize(name + 1, missing);
+  }
+  table[name] = value;
+}
+
+}  // namespace
+
+/**
+ * @brief Constructs a compiler for the given RPN program.
+ *
+ * @param rpn Cells produced by RPN::getRPN()
+ */
+BytecodeCompiler::BytecodeCompiler(const std::vector<RPNCell>& rpn)
+    : rpn_(rpn) {}
+
+/**
+ * @brief Lowers the RPN cells into a Program.
+ *
+ * Cells are translated in order. Jumps are emitted with the index of their
+ * target cell and patched with the instruction index of that cell once the
+ * whole program has been emitted.
+ *
+ * @return Program The compiled program
+ * @throws std::runtime_error on malformed cells or unresolved names
+ */
+Program BytecodeCompiler::Compile() {
+  program_ = Program();
+  CollectFunctions();
+  cellToInstruction_.assign(rpn_.size() + 1, 0);
+
+  std::vector<std::pair<SymbolId, size_t>> targets;
+  for (size_t i = 0; i < rpn_.size(); ++i) {
+    const RPNCell& cell = rpn_[i];
+    cellToInstruction_[i] = program_.code.size();
+    switch (cell.type) {
+      case CellType::VarCell:
+        targets.emplace_back(SymbolOf(cell), program_.code.size());
+        break;
+      case CellType::ConstCell:
+        Emit(OpCode::PushConst, AddConstant(cell.value));
+        break;
+      case CellType::LoadCell:
+        CompileLoad(SymbolOf(cell));
+        break;
+      case CellType::MathCell:
+        if (cell.op != Operator::Unknown) {
+          CompileOperator(cell);
+          break;
+        }
+        if (targets.empty()) {
+          throw std::runtime_error("Assignment without target");
+        }
+        if (targets.back().second == program_.code.size()) {
+          Emit(OpCode::PushConst, AddConstant("0"));
+        }
+        CompileStore(targets.back().first);
+        targets.pop_back();
+        break;
+      case CellType::ConditionalJumpCell:
+        jumpFixups_.emplace_back(program_.code.size(), ResolveJump(i));
+        Emit(OpCode::JumpIfFalse);
+        break;
+      case CellType::GoToCell:
+        jumpFixups_.emplace_back(program_.code.size(), ResolveJump(i));
+        Emit(OpCode::Jump);
+        break;
+      case CellType::CallCeil: {
+        if (i + 1 >= rpn_.size() || rpn_[i + 1].type != CellType::GoToCell) {
+          throw std::runtime_error("Malformed call of function: " +
+                                   cell.value);
+        }
+        auto it = functionAtCell_.find(ResolveJump(i + 1));
+        if (it == functionAtCell_.end()) {
+          throw std::runtime_error("Undefined function: " + cell.value);
+        }
+        Emit(OpCode::Call, program_.callSites.size());
+        program_.callSites.push_back(CallSite{cell.value, it->second});
+        cellToInstruction_[++i] = program_.code.size();
+        break;
+      }
+      case CellType::ReturnCell:
+        if (currentFunction_ < 0) {
+          throw std::runtime_error("'return' outside of a function");
+        }
+        Emit(OpCode::Return);
+        break;
+      case CellType::LabelCell:
+        if (IsLabel(cell, "end_func") && currentFunction_ >= 0) {
+          Emit(OpCode::Leave);
+          LeaveFunction();
+        }
+        break;
+      case CellType::FunctionCell: {
+        if (IsBuiltin(cell.value)) {
+          Emit(OpCode::Print);
+          break;
+        }
+        EnterFunction(functionAtCell_.at(i));
+        FunctionInfo& function = program_.functions[currentFunction_];
+        jumpFixups_.emplace_back(program_.code.size(),
+                                 FindFunctionEnd(i) + 1);
+        Emit(OpCode::Jump);
+        size_t body = i + function.arity + 2;
+        for (++i; i < body; ++i) {
+          cellToInstruction_[i] = program_.code.size();
+        }
+        --i;
+        function.entry = program_.code.size();
+        break;
+      }
+    }
+  }
+  cellToInstruction_[rpn_.size()] = program_.code.size();
+
+  for (const auto& [instruction, cell] : jumpFixups_) {
+    program_.code[instruction].arg = cellToInstruction_[cell];
+  }
+  jumpFixups_.clear();
+  LeaveFunction();
+  return std::move(program_);
+}
+
+/**
+ * @brief Builds the function table and the set of names assigned at top
+ * level.
+ *
+ * A definition is laid out as FunctionCell(name), one VarCell per
+ * parameter, LabelCell(begin_func_N), body, LabelCell(end_func_N).
+ *
+ * @throws std::runtime_error if a definition is malformed
+ */
+void BytecodeCompiler::CollectFunctions() {
+  functionAtCell_.clear();
+  functionCells_.clear();
+  functionLocals_.clear();
+  topLevelNames_.clear();
+  for (size_t i = 0; i < rpn_.size(); ++i) {
+    const RPNCell& cell = rpn_[i];
+    if (cell.type == CellType::VarCell) {
+      SetAt(topLevelNames_, SymbolOf(cell), true, false);
+    }
+    if (cell.type != CellType::FunctionCell || IsBuiltin(cell.value)) {
+      continue;
+    }
+    FunctionInfo function;
+    function.name = cell.value;
+    function.entry = 0;
+    std::vector<SymbolId> locals;
+    size_t j = i + 1;
+    while (j < rpn_.size() && rpn_[j].type == CellType::VarCell) {
+      function.localNames.push_back(rpn_[j].value);
+      locals.push_back(SymbolOf(rpn_[j]));
+      ++j;
+    }
+    if (j >= rpn_.size() || !IsLabel(rpn_[j], "begin_func")) {
+      throw std::runtime_error("Malformed definition of function: " +
+                               cell.value);
+    }
+    function.arity = function.localNames.size();
+    functionAtCell_[i] = program_.functions.size();
+    functionCells_.push_back(i);
+    functionLocals_.push_back(std::move(locals));
+    program_.functions.push_back(function);
+    i = FindFunctionEnd(i);
+  }
+  for (size_t f = 0; f < program_.functions.size(); ++f) {
+    CollectLocals(functionCells_[f], program_.functions[f]);
+  }
+}
+
+/**
+ * @brief Maps the locals of a function to its frame slots while its body
+ * is compiled.
+ */
+void BytecodeCompiler::EnterFunction(uint32_t function) {
+  LeaveFunction();
+  currentFunction_ = function;
+  const std::vector<SymbolId>& locals = functionLocals_[function];
+  for (uint32_t slot = 0; slot < locals.size(); ++slot) {
+    SetAt(localIndex_, locals[slot], slot, kNoSlot);
+  }
+}
+
+/**
+ * @brief Unmaps the locals of the current function, if any.
+ */
+void BytecodeCompiler::LeaveFunction() {
+  if (currentFunction_ >= 0) {
+    for (SymbolId local : functionLocals_[currentFunction_]) {
+      localIndex_[local] = kNoSlot;
+    }
+  }
+  currentFunction_ = -1;
+}
+
+/**
+ * @brief Assigns frame slots to the variables a function writes.
+ *
+ * @param definition Index of the FunctionCell of the definition
+ * @param function Entry whose localNames already holds the parameters
+ */
+void BytecodeCompiler::CollectLocals(size_t definition,
+                                     FunctionInfo& function) {
+  std::vector<SymbolId>& locals = functionLocals_[functionAtCell_[definition]];
+  size_t end = FindFunctionEnd(definition);
+  for (size_t i = definition + function.arity + 2; i < end; ++i) {
+    if (rpn_[i].type != CellType::VarCell) {
+      continue;
+    }
+    SymbolId name = SymbolOf(rpn_[i]);
+    if (topLevelNames_.size() > name && topLevelNames_[name]) {
+      continue;
+    }
+    bool known = false;
+    for (SymbolId local : locals) {
+      known = known || local == name;
+    }
+    if (!known) {
+      function.localNames.push_back(rpn_[i].value);
+      locals.push_back(name);
+    }
+  }
+  function.frameSize = function.localNames.size();
+}
+
+/**
+ * @brief Emits the instruction of an operator cell.
+ *
+ * @throws std::runtime_error for subscripts and calls inside expressions,
+ *         which the machines cannot execute
+ */
+void BytecodeCompiler::CompileOperator(const RPNCell& cell) {
+  switch (cell.op) {
+    case Operator::Add:
+      Emit(OpCode::Add);
+      break;
+    case Operator::Sub:
+      Emit(OpCode::Sub);
+      break;
+    case Operator::Mul:
+      Emit(OpCode::Mul);
+      break;
+    case Operator::Div:
+      Emit(OpCode::Div);
+      break;
+    case Operator::Mod:
+      Emit(OpCode::Mod);
+      break;
+    case Operator::Less:
+      Emit(OpCode::Less);
+      break;
+    case Operator::Greater:
+      Emit(OpCode::Greater);
+      break;
+    case Operator::LessEqual:
+      Emit(OpCode::LessEqual);
+      break;
+    case Operator::GreaterEqual:
+      Emit(OpCode::GreaterEqual);
+      break;
+    case Operator::Equal:
+      Emit(OpCode::Equal);
+      break;
+    case Operator::NotEqual:
+      Emit(OpCode::NotEqual);
+      break;
+    case Operator::And:
+      Emit(OpCode::And);
+      break;
+    case Operator::Or:
+      Emit(OpCode::Or);
+      break;
+    case Operator::Not:
+      Emit(OpCode::Not);
+      break;
+    case Operator::Negate:
+      Emit(OpCode::Negate);
+      break;
+    case Operator::Index:
+      throw std::runtime_error("Arrays are not supported");
+    case Operator::Call:
+      throw std::runtime_error("Calls inside expressions are not supported: " +
+                               cell.value);
+    default:
+      throw std::runtime_error("Unknown operator: " + cell.value);
+  }
+}
+
+/**
+ * @brief Emits a read of a variable from its frame or global slot.
+ */
+void BytecodeCompiler::CompileLoad(SymbolId name) {
+  uint32_t slot = LocalSlot(name);
+  if (slot != kNoSlot) {
+    Emit(OpCode::LoadLocal, slot);
+  } else {
+    Emit(OpCode::LoadGlobal, GlobalSlot(name));
+  }
+}
+
+/**
+ * @brief Emits a write of the top of the stack to a frame or global slot.
+ */
+void BytecodeCompiler::CompileStore(SymbolId name) {
+  uint32_t slot = LocalSlot(name);
+  if (slot != kNoSlot) {
+    Emit(OpCode::StoreLocal, slot);
+  } else {
+    Emit(OpCode::StoreGlobal, GlobalSlot(name));
+  }
+}
+
+/**
+ * @brief Returns the cell a jump refers to.
+ *
+ * RPN::buildRPN() back-patches every jump with the absolute index of its
+ * target cell.
+ *
+ * @param index Position of the GoToCell or ConditionalJumpCell
+ * @throws std::runtime_error if the jump was left unresolved
+ */
+size_t BytecodeCompiler::ResolveJump(size_t index) const {
+  const std::string& target = rpn_[index].value;
+  if (target.empty() || !isdigit(target[0]) ||
+      std::stoul(target) >= rpn_.size()) {
+    throw std::runtime_error("Unresolved jump target: " + target);
+  }
+  return std::stoul(target);
+}
+
+/**
+ * @brief Returns the index of the end_func label closing a definition.
+ *
+ * @throws std::runtime_error if the definition is not closed
+ */
+size_t BytecodeCompiler::FindFunctionEnd(size_t index) const {
+  for (size_t i = index + 1; i < rpn_.size(); ++i) {
+    if (IsLabel(rpn_[i], "end_func")) {
+      return i;
+    }
+  }
+  throw std::runtime_error("Missing end of function: " + rpn_[index].value);
+}
+
+/**
+ * @brief Returns the constant pool index of a literal, adding it once.
+ */
+uint32_t BytecodeCompiler::AddConstant(const std::string& literal) {
+  auto it = constantIndex_.find(literal);
+  if (it != constantIndex_.end()) {
+    return it->second;
+  }
+  uint32_t index = program_.constants.size();
+  program_.constants.push_back(Value::FromLiteral(literal));
+  constantIndex_[literal] = index;
+  return index;
+}
+
+/**
+ * @brief Returns the frame slot of a name in the current function, kNoSlot
+ * if it is not one of its locals.
+ */
+uint32_t BytecodeCompiler::LocalSlot(SymbolId name) const {
+  return name < localIndex_.size() ? localIndex_[name] : kNoSlot;
+}
+
+/**
+ * @brief Returns the global slot of a name, allocating it on first use.
+ */
+uint32_t BytecodeCompiler::GlobalSlot(SymbolId name) {
+  if (name < globalIndex_.size() && globalIndex_[name] != kNoSlot) {
+    return globalIndex_[name];
+  }
+  uint32_t slot = program_.globalNames.size();
+  program_.globalNames.emplace_back(SymbolName(name));
+  SetAt(globalIndex_, name, slot, kNoSlot);
+  return slot;
+}
+
+/**
+ * @brief Appends an instruction to the program.
+ *
+ * @throws std::runtime_error if the operand does not fit in 24 bits
+ */
+void BytecodeCompiler::Emit(OpCode op, uint32_t arg) {
+  if (arg > kMaxOperand || program_.code.size() > kMaxOperand) {
+    throw std::runtime_error("Program too large for the bytecode format");
+  }
+  program_.code.push_back(Instruction{op, arg});
+}
@@ -0,0 +1,321 @@
+#include "CompileCache.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <stdexcept>
+#include <system_error>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+const char kMagic[4] = {'S', 'R', 'P', 'N'};
+// Bump whenever the entry layout or the meaning of a cell changes, so
+// entries of an older backend are missed instead of misread.
+const uint32_t kFormatVersion = 1;
+const char kEntrySuffix[] = ".rpn";
+
+uint64_t Fnv1a(std::string_view text) {
+  uint64_t hash = 14695981039346656037ULL;
+  for (char c : text) {
+    hash ^= static_cast<unsigned char>(c);
+    hash *= 1099511628211ULL;
+  }
+  return hash;
+}
+
+/**
+ * @brief Appends fixed-size values and strings to an entry
+ */
+class Writer {
+ public:
+  template <typename T>
+  void Put(T value) {
+    data_.append(reinterpret_cast<const char*>(&value), sizeof(value));
+  }
+
+  void PutString(std::string_view text) {
+    Put<uint64_t>(text.size());
+    data_.append(text);
+  }
+
+  void PutCells(const std::vector<RPNCell>& cells) {
+    Put<uint64_t>(cells.size());
+    for (const RPNCell& cell : cells) {
+      Put<uint8_t>(static_cast<uint8_t>(cell.type));
+      Put<uint8_t>(static_cast<uint8_t>(cell.op));
+      Put<uint8_t>(cell.symbol != kNoSymbol);
+      Put<uint32_t>(cell.arity);
+      PutString(cell.value);
+    }
+  }
+
+  const std::string& Data() const { return data_; }
+
+ private:
+  std::string data_;
+};
+
+/**
+ * @brief Reads back what Writer wrote; every read fails once the entry
+ * turns out to be short or malformed
+ */
+class Reader {
+ public:
+  explicit Reader(std::string_view data) : data_(data) {}
+
+  template <typename T>
+  bool Get(T& value) {
+    if (data_.size() < sizeof(value)) {
+      return false;
+    }
+    std::memcpy(&value, data_.data(), sizeof(value));
+    data_.remove_prefix(sizeof(value));
+    return true;
+  }
+
+  bool GetString(std::string& text) {
+    uint64_t size;
+    if (!Get(size) || data_.size() < size) {
+      return false;
+    }
+    text.assign(data_.substr(0, size));
+    data_.remove_prefix(size);
+    return true;
+  }
+
+  bool GetCells(std::vector<RPNCell>& cells) {
+    uint64_t count;
+    if (!Get(count) || count > data_.size()) {
+      return false;
+    }
+    cells.reserve(count);
+    for (uint64_t i = 0; i < count; ++i) {
+      uint8_t type;
+      uint8_t op;
+      uint8_t named;
+      uint32_t arity;
+      std::string value;
+      if (!Get(type) || !Get(op) || !Get(named) || !Get(arity) ||
+          !GetString(value) ||
+          type > static_cast<uint8_t>(CellType::LoadCell) ||
+          op > static_cast<uint8_t>(Operator::Unknown)) {
+        return false;
+      }
+      SymbolId symbol = named ? InternSymbol(value) : kNoSymbol;
+      cells.emplace_back(static_cast<CellType>(type), std::move(value), symbol);
+      cells.back().op = static_cast<Operator>(op);
+      cells.back().arity = arity;
+    }
+    return true;
+  }
+
+  bool AtEnd() const { return data_.empty(); }
+
+ private:
+  std::string_view data_;
+};
+
+std::string Serialize(const std::string& key, const CompiledProgram& program) {
+  Writer writer;
+  for (char c : kMagic) {
+    writer.Put(c);
+  }
+  writer.Put(kFormatVersion);
+  writer.PutString(key);
+  writer.Put<uint64_t>(program.stats.cellsBefore);
+  writer.Put<uint64_t>(program.stats.cellsAfter);
+  writer.Put<uint64_t>(program.stats.foldedOperators);
+  writer.Put<uint64_t>(program.stats.threadedJumps);
+  writer.PutCells(program.listing);
+  writer.PutCells(program.cells);
+  return writer.Data();
+}
+
+/**
+ * @brief Parses an entry.
+ *
+ * @return false if the entry is malformed or of another format version
+ */
+bool Deserialize(std::string_view data, std::string& key,
+                 CompiledProgram& program) {
+  Reader reader(data);
+  char magic[sizeof(kMagic)];
+  uint32_t version;
+  for (char& c : magic) {
+    if (!reader.Get(c)) {
+      return false;
+    }
+  }
+  if (std::memcmp(magic, kMagic, sizeof(kMagic)) != 0 ||
+      !reader.Get(version) || version != kFormatVersion ||
+      !reader.GetString(key)) {
+    return false;
+  }
+  uint64_t before;
+  uint64_t after;
+  uint64_t folded;
+  uint64_t threaded;
+  if (!reader.Get(before) || !reader.Get(after) || !reader.Get(folded) ||
+      !reader.Get(threaded) || !reader.GetCells(program.listing) ||
+      !reader.GetCells(program.cells) || !reader.AtEnd()) {
+    return false;
+  }
+  program.stats.cellsBefore = before;
+  program.stats.cellsAfter = after;
+  program.stats.foldedOperators = folded;
+  program.stats.threadedJumps = threaded;
+  return true;
+}
+
+}  // namespace
+
+/**
+ * @brief Opens the cache in a directory, creating it if needed.
+ *
+ * @param directory Directory holding the entries
+ * @param capacity Total size in bytes the entries may take up
+ * @throws std::runtime_error if the directory cannot be created
+ */
+CompileCache::CompileCache(std::string directory, uint64_t capacity)
+    : directory_(std::move(directory)), capacity_(capacity) {
+  std::error_code error;
+  fs::create_directories(directory_, error);
+  if (error || !fs::is_directory(directory_)) {
+    throw std::runtime_error("Failed to open cache directory '" +
+                             directory_ + "'");
+  }
+}
+
+/**
+ * @brief Returns the key of a program: its source together with the
+ * keyword set it is lexed with and the level it is optimized at.
+ *
+ * @param keywords Custom keyword set, null for the built-in keywords
+ */
+std::string CompileCache::Key(std::string_view code, const bor* keywords,
+                              int optimizationLevel) {
+  std::string key = "O" + std::to_string(optimizationLevel) + "\n";
+  if (keywords == nullptr) {
+    key += "builtin keywords\n";
+  } else {
+    key += std::to_string(keywords->size()) + " keywords\n";
+    for (size_t i = 0; i < keywords->size(); ++i) {
+      key += keywords->word(static_cast<int>(i));
+      key += '\n';
+    }
+  }
+  key.append(code);
+  return key;
+}
+
+/**
+ * @brief Loads the program stored under a key and marks it recently used.
+ *
+ * @return The program, or nothing on a miss
+ */
+std::optional<CompiledProgram> CompileCache::Lookup(const std::string& key) {
+  std::string path = PathOf(key);
+  std::ifstream file(path, std::ios::binary);
+  if (file) {
+    std::string data((std::istreambuf_iterator<char>(file)),
+                     std::istreambuf_iterator<char>());
+    file.close();
+    std::string storedKey;
+    CompiledProgram program;
+    if (Deserialize(data, storedKey, program)) {
+      if (storedKey == key) {
+        std::error_code error;
+        fs::last_write_time(path, fs::file_time_type::clock::now(), error);
+        ++stats_.hits;
+        return program;
+      }
+    } else {
+      std::error_code error;
+      fs::remove(path, error);
+    }
+  }
+  ++stats_.misses;
+  return std::nullopt;
+}
+
+/**
+ * @brief Stores a program under a key, then evicts the least recently used
+ * entries until the directory fits its capacity.
+ *
+ * The cache only saves work, so an entry that cannot be written is
+ * dropped silently.
+ */
+void CompileCache::Store(const std::string& key,
+                         const CompiledProgram& program) {
+  std::string path = PathOf(key);
+  std::string temporary =
+      path + "." + std::to_string(std::random_device()()) + ".tmp";
+  std::string data = Serialize(key, program);
+  {
+    std::ofstream file(temporary, std::ios::binary);
+    if (!file.write(data.data(), data.size())) {
+      file.close();
+      std::error_code error;
+      fs::remove(temporary, error);
+      return;
+    }
+  }
+  std::error_code error;
+  fs::rename(temporary, path, error);
+  if (error) {
+    fs::remove(temporary, error);
+    return;
+  }
+  ++stats_.stores;
+  Evict();
+}
+
+std::string CompileCache::PathOf(const std::string& key) const {
+  char name[17];
+  std::snprintf(name, sizeof(name), "%016llx",
+                static_cast<unsigned long long>(Fnv1a(key)));
+  return (fs::path(directory_) / (name + std::string(kEntrySuffix)))
+      .string();
+}
+
+void CompileCache::Evict() {
+  struct Entry {
+    fs::file_time_type used;
+    uint64_t size;
+    fs::path path;
+  };
+  std::vector<Entry> entries;
+  uint64_t total = 0;
+  std::error_code error;
+  for (const auto& file : fs::directory_iterator(directory_, error)) {
+    if (file.path().extension() != kEntrySuffix) {
+      continue;
+    }
+    std::error_code statError;
+    uint64_t size = file.file_size(statError);
+    fs::file_time_type used = file.last_write_time(statError);
+    if (!statError) {
+      entries.push_back({used, size, file.path()});
+      total += size;
+    }
+  }
+  if (total <= capacity_) {
+    return;
+  }
+  std::sort(entries.begin(), entries.end(),
+            [](const Entry& a, const Entry& b) { return a.used < b.used; });
+  for (const Entry& entry : entries) {
+    if (total <= capacity_) {
+      break;
+    }
+    if (fs::remove(entry.path, error)) {
+      ++stats_.evictions;
+    }
+    total -= entry.size;
+  }
+}
@@ -0,0 +1,495 @@
+#include "CppEmitter.h"
+#include <cctype>
+#include <cstdlib>
+#include <sstream>
+#include <stdexcept>
+#include "Value.h"
+
+namespace {
+
+const char* const kPrelude = R"(#include <cmath>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+namespace {
+
+template <typename A, typename B>
+auto sigma_div(A a, B b) -> decltype(a / b) {
+  if (b == 0) {
+    throw std::runtime_error("Division by zero");
+  }
+  return a / b;
+}
+
+template <typename A, typename B>
+auto sigma_mod(A a, B b) -> decltype(a / b) {
+  if (b == 0) {
+    throw std::runtime_error("Division by zero");
+  }
+  if constexpr (std::is_floating_point_v<decltype(a / b)>) {
+    return std::fmod(a, b);
+  } else {
+    return a % b;
+  }
+}
+
+bool sigma_truthy(long long value) { return value != 0; }
+
+bool sigma_truthy(double value) { return value != 0.0; }
+
+bool sigma_truthy(const std::string& value) { return !value.empty(); }
+
+void sigma_print(long long value) { std::cout << value << '\n'; }
+
+void sigma_print(double value) { std::cout << value << '\n'; }
+
+void sigma_print(const std::string& value) { std::cout << value << '\n'; }
+
+)";
+
+// C++ spelling of the operators that map to a built-in one
+const char* CppOperator(Operator op) {
+  switch (op) {
+    case Operator::Add:
+      return "+";
+    case Operator::Sub:
+      return "-";
+    case Operator::Mul:
+      return "*";
+    case Operator::Less:
+      return "<";
+    case Operator::Greater:
+      return ">";
+    case Operator::LessEqual:
+      return "<=";
+    case Operator::GreaterEqual:
+      return ">=";
+    case Operator::Equal:
+      return "==";
+    case Operator::NotEqual:
+      return "!=";
+    default:
+      return nullptr;
+  }
+}
+
+bool IsBuiltin(const std::string& name) {
+  return name == "print";
+}
+
+bool IsLabel(const RPNCell& cell, const std::string& kind) {
+  return cell.type == CellType::LabelCell &&
+         cell.value.compare(0, kind.size() + 1, kind + "_") == 0;
+}
+
+std::string CppType(ValueType type) {
+  switch (type) {
+    case ValueType::Int:
+    case ValueType::Bool:
+      return "long long";
+    case ValueType::Float:
+      return "double";
+    case ValueType::Char:
+    case ValueType::String:
+      return "std::string";
+    default:
+      return "";
+  }
+}
+
+std::string Quote(const std::string& text) {
+  std::string quoted = "\"";
+  for (char c : text) {
+    if (c == '"' || c == '\\') {
+      quoted += '\\';
+    }
+    quoted += c;
+  }
+  return quoted + "\"";
+}
+
+}  // namespace
+
+/**
+ * @brief Constructs an emitter for an RPN program.
+ *
+ * @param rpn Cells produced by RPN::getRPN()
+ * @param semantic Analyzer that has run Analyze() on the same program
+ */
+CppEmitter::CppEmitter(const std::vector<RPNCell>& rpn,
+                       const SemanticAnalyzer& semantic)
+    : rpn_(rpn),
+      types_(semantic.GetVariableTypes()),
+      signatures_(semantic.GetFunctionSignatures()) {}
+
+/**
+ * @brief Produces the translation unit.
+ *
+ * @return std::string C++ source of a program printing what the
+ *         interpreter would print
+ */
+std::string CppEmitter::Emit() {
+  CollectFunctions();
+
+  std::set<std::string> globals = topLevelNames_;
+  for (const auto& [name, type] : types_[kNoSymbol]) {
+    globals.emplace(SymbolName(name));
+  }
+
+  std::ostringstream out;
+  out << kPrelude;
+  current_ = nullptr;
+  for (const std::string& name : globals) {
+    out << TypeOf(name) << " " << Variable(name) << "{};\n";
+  }
+  out << "\n";
+
+  std::ostringstream definitions;
+  for (const Function& function : functions_) {
+    std::string definition = EmitFunction(function);
+    out << definition.substr(0, definition.find(" {")) << ";\n";
+    definitions << "\n" << definition;
+  }
+  out << definitions.str() << "\n}  // namespace\n\n";
+
+  current_ = nullptr;
+  out << "int main() {\n"
+      << "  std::ios::sync_with_stdio(false);\n"
+      << "  try {\n"
+      << EmitStatements(0, rpn_.size())
+      << "  } catch (const std::exception& e) {\n"
+      << "    std::cout << \"Error: \" << e.what() << std::endl;\n"
+      << "    return 1;\n"
+      << "  }\n"
+      << "  return 0;\n"
+      << "}\n";
+  return out.str();
+}
+
+/**
+ * @brief Compiles an emitted translation unit with clang++.
+ *
+ * The compiler can be overridden with the SIGMA_CXX environment variable.
+ *
+ * @throws std::runtime_error if a path cannot be quoted or the compiler
+ *         fails
+ */
+void CppEmitter::BuildExecutable(const std::string& sourcePath,
+                                 const std::string& outputPath) {
+  if (sourcePath.find('\'') != std::string::npos ||
+      outputPath.find('\'') != std::string::npos) {
+    throw std::runtime_error("Unsupported character in output path");
+  }
+  const char* compiler = std::getenv("SIGMA_CXX");
+  std::string command = std::string(compiler ? compiler : "clang++") +
+                        " -std=c++20 -O2 -o '" + outputPath + "' '" +
+                        sourcePath + "'";
+  if (std::system(command.c_str()) != 0) {
+    throw std::runtime_error("Native compilation failed: " + command);
+  }
+}
+
+/**
+ * @brief Builds the function table and the set of names assigned at top
+ * level.
+ *
+ * @throws std::runtime_error if a definition is malformed
+ */
+void CppEmitter::CollectFunctions() {
+  functions_.clear();
+  functionAtCell_.clear();
+  topLevelNames_.clear();
+  for (size_t i = 0; i < rpn_.size(); ++i) {
+    const RPNCell& cell = rpn_[i];
+    if (cell.type == CellType::VarCell) {
+      topLevelNames_.insert(cell.value);
+    }
+    if (cell.type != CellType::FunctionCell || IsBuiltin(cell.value)) {
+      continue;
+    }
+    Function function;
+    function.name = cell.value;
+    function.symbol = cell.symbol;
+    size_t j = i + 1;
+    while (j < rpn_.size() && rpn_[j].type == CellType::VarCell) {
+      function.parameters.push_back(rpn_[j].value);
+      ++j;
+    }
+    if (j >= rpn_.size() || !IsLabel(rpn_[j], "begin_func")) {
+      throw std::runtime_error("Malformed definition of function: " +
+                               cell.value);
+    }
+    function.body = j + 1;
+    function.end = FindFunctionEnd(i);
+    functionAtCell_[i] = functions_.size();
+    functions_.push_back(function);
+    i = function.end;
+  }
+  for (Function& function : functions_) {
+    function.locals.insert(function.parameters.begin(),
+                           function.parameters.end());
+    for (size_t i = function.body; i < function.end; ++i) {
+      if (rpn_[i].type == CellType::VarCell &&
+          !topLevelNames_.count(rpn_[i].value)) {
+        function.locals.insert(rpn_[i].value);
+      }
+    }
+  }
+}
+
+/**
+ * @brief Returns the index of the end_func label closing a definition.
+ *
+ * @throws std::runtime_error if the definition is not closed
+ */
+size_t CppEmitter::FindFunctionEnd(size_t index) const {
+  for (size_t i = index + 1; i < rpn_.size(); ++i) {
+    if (IsLabel(rpn_[i], "end_func")) {
+      return i;
+    }
+  }
+  throw std::runtime_error("Missing end of function: " + rpn_[index].value);
+}
+
+/**
+ * @brief Emits the definition of a function: signature, declarations of
+ * its locals and its body.
+ */
+std::string CppEmitter::EmitFunction(const Function& function) {
+  current_ = &function;
+  const auto& signature = signatures_[function.symbol];
+  std::ostringstream out;
+  out << "void f_" << function.name << "(";
+  for (size_t i = 0; i < function.parameters.size(); ++i) {
+    std::string type = i < signature.size() ? CppType(signature[i]) : "";
+    out << (i ? ", " : "")
+        << (type.empty() ? TypeOf(function.parameters[i]) : type) << " "
+        << Variable(function.parameters[i]);
+  }
+  out << ") {\n";
+  for (const std::string& name : function.locals) {
+    bool parameter = false;
+    for (const auto& p : function.parameters) {
+      parameter = parameter || p == name;
+    }
+    if (!parameter) {
+      out << "  " << TypeOf(name) << " " << Variable(name) << "{};\n";
+    }
+  }
+  out << EmitStatements(function.body, function.end) << "}\n";
+  current_ = nullptr;
+  return out.str();
+}
+
+/**
+ * @brief Emits the statements of the cells in [begin, end), skipping
+ * nested function definitions.
+ */
+std::string CppEmitter::EmitStatements(size_t begin, size_t end) {
+  std::ostringstream out;
+  std::string indent = current_ ? "  " : "    ";
+  std::vector<std::pair<std::string, size_t>> targets;
+  stack_.clear();
+  for (size_t i = begin; i < end; ++i) {
+    const RPNCell& cell = rpn_[i];
+    switch (cell.type) {
+      case CellType::VarCell:
+        targets.emplace_back(cell.value, stack_.size());
+        break;
+      case CellType::ConstCell:
+        stack_.push_back(Literal(cell.value));
+        break;
+      case CellType::LoadCell:
+        stack_.push_back(Variable(cell.value));
+        break;
+      case CellType::MathCell: {
+        if (cell.op != Operator::Unknown) {
+          stack_.push_back(Operation(cell));
+          break;
+        }
+        if (targets.empty()) {
+          throw std::runtime_error("Assignment without target");
+        }
+        bool declaration = targets.back().second == stack_.size();
+        out << indent << Variable(targets.back().first) << " = "
+            << (declaration ? "{}" : Pop()) << ";\n";
+        targets.pop_back();
+        break;
+      }
+      case CellType::ConditionalJumpCell:
+        out << indent << "if (!(" << Pop() << ")) goto "
+            << JumpTarget(i) << ";\n";
+        break;
+      case CellType::GoToCell:
+        if (i > begin && rpn_[i - 1].type == CellType::ReturnCell) {
+          break;
+        }
+        out << indent << "goto " << JumpTarget(i) << ";\n";
+        break;
+      case CellType::CallCeil: {
+        if (i + 1 >= rpn_.size() || rpn_[i + 1].type != CellType::GoToCell) {
+          throw std::runtime_error("Malformed call of function: " +
+                                   cell.value);
+        }
+        auto it = functionAtCell_.find(std::stoul(rpn_[i + 1].value));
+        if (it == functionAtCell_.end()) {
+          throw std::runtime_error("Undefined function: " + cell.value);
+        }
+        size_t arity = functions_[it->second].parameters.size();
+        if (stack_.size() < arity) {
+          throw std::runtime_error("Not enough arguments for function: " +
+                                   cell.value);
+        }
+        std::string arguments;
+        for (size_t a = stack_.size() - arity; a < stack_.size(); ++a) {
+          arguments += (arguments.empty() ? "" : ", ") + stack_[a];
+        }
+        stack_.resize(stack_.size() - arity);
+        out << indent << "f_" << cell.value << "(" << arguments << ");\n";
+        ++i;
+        break;
+      }
+      case CellType::ReturnCell:
+        if (!current_) {
+          throw std::runtime_error("'return' outside of a function");
+        }
+        out << indent << "(void)(" << Pop() << ");\n"
+            << indent << "return;\n";
+        break;
+      case CellType::LabelCell:
+        if (!IsLabel(cell, "begin_func") && !IsLabel(cell, "end_func")) {
+          out << cell.value << ":;\n";
+        }
+        break;
+      case CellType::FunctionCell:
+        if (!IsBuiltin(cell.value)) {
+          i = FindFunctionEnd(i);
+          break;
+        }
+        if (stack_.empty()) {
+          out << indent << "std::cout << '\\n';\n";
+        } else {
+          out << indent << "sigma_print(" << Pop() << ");\n";
+        }
+        break;
+    }
+  }
+  return out.str();
+}
+
+/**
+ * @brief Pops the operands of an operator cell and combines them into a
+ * C++ expression. Comparisons and logical operators produce 0 or 1, as in
+ * the interpreter.
+ *
+ * @throws std::runtime_error for subscripts and calls inside expressions,
+ *         or if operands are missing
+ */
+std::string CppEmitter::Operation(const RPNCell& cell) {
+  if (cell.op == Operator::Index) {
+    throw std::runtime_error("Arrays are not supported");
+  }
+  if (cell.op == Operator::Call) {
+    throw std::runtime_error("Calls inside expressions are not supported: " +
+                             cell.value);
+  }
+  if (stack_.size() < cell.arity) {
+    throw std::runtime_error("Operand stack underflow");
+  }
+  if (cell.arity == 1) {
+    std::string operand = Pop();
+    if (cell.op == Operator::Negate) {
+      return "(-" + operand + ")";
+    }
+    return "static_cast<long long>(!sigma_truthy(" + operand + "))";
+  }
+  std::string rhs = Pop();
+  std::string lhs = Pop();
+  switch (cell.op) {
+    case Operator::Add:
+    case Operator::Sub:
+    case Operator::Mul:
+      return "(" + lhs + " " + CppOperator(cell.op) + " " + rhs + ")";
+    case Operator::Div:
+      return "sigma_div(" + lhs + ", " + rhs + ")";
+    case Operator::Mod:
+      return "sigma_mod(" + lhs + ", " + rhs + ")";
+    case Operator::And:
+    case Operator::Or:
+      return "static_cast<long long>(sigma_truthy(" + lhs + ") " +
+             (cell.op == Operator::And ? "&&" : "||") + " sigma_truthy(" +
+             rhs + "))";
+    default:
+      return "static_cast<long long>(" + lhs + " " + CppOperator(cell.op) +
+             " " + rhs + ")";
+  }
+}
+
+/**
+ * @brief Translates the literal of a Const cell.
+ */
+std::string CppEmitter::Literal(const std::string& literal) const {
+  if (literal[0] == '"') {
+    return "std::string(" + Quote(literal.substr(1, literal.size() - 2)) +
+           ")";
+  }
+  return literal.find('.') == std::string::npos ? literal + "LL" : literal;
+}
+
+/**
+ * @brief Returns the C++ identifier of a variable. The prefix keeps user
+ * names clear of C++ keywords and library names.
+ */
+std::string CppEmitter::Variable(const std::string& name) const {
+  return "v_" + name;
+}
+
+/**
+ * @brief Returns the C++ type of a variable in the current function.
+ *
+ * @throws std::runtime_error if the analyzer recorded no usable type
+ */
+std::string CppEmitter::TypeOf(const std::string& name) const {
+  SymbolId scope = current_ && current_->locals.count(name)
+                       ? current_->symbol
+                       : kNoSymbol;
+  auto it = types_.find(scope);
+  if (it != types_.end()) {
+    auto type = it->second.find(LookupSymbol(name));
+    if (type != it->second.end() && !CppType(type->second).empty()) {
+      return CppType(type->second);
+    }
+  }
+  throw std::runtime_error("Cannot determine the type of variable: " + name);
+}
+
+/**
+ * @brief Returns the C++ label a jump refers to.
+ *
+ * @throws std::runtime_error if the jump does not target a label
+ */
+std::string CppEmitter::JumpTarget(size_t index) const {
+  const std::string& target = rpn_[index].value;
+  if (target.empty() || !isdigit(target[0]) ||
+      std::stoul(target) >= rpn_.size() ||
+      rpn_[std::stoul(target)].type != CellType::LabelCell) {
+    throw std::runtime_error("Unresolved jump target: " + target);
+  }
+  return rpn_[std::stoul(target)].value;
+}
+
+/**
+ * @brief Pops the innermost pending expression.
+ *
+ * @throws std::runtime_error if there is none
+ */
+std::string CppEmitter::Pop() {
+  if (stack_.empty()) {
+    throw std::runtime_error("Operand stack underflow");
+  }
+  std::string top = std::move(stack_.back());
+  stack_.pop_back();
+  return top;
+}
@@ -0,0 +1,168 @@
+#include "Driver.h"
+#include <Bytecode.h>
+#include <CompileCache.h>
+#include <CppEmitter.h>
+#include <Optimizer.h>
+#include <ProgramImage.h>
+#include <RPN.h>
+#include <RegisterCode.h>
+#include <RegisterMachine.h>
+#include <SyntaxAnalyzer.h>
+#include <fstream>
+#include <iostream>
+#include <optional>
+#include "LexemAnalyzer.h"
+#include "Semantic.h"
+
+namespace {
+
+void PrintStats(const OptimizerStats& stats, const CompileCache* cache) {
+  std::cerr << "Optimizer: " << stats.cellsBefore << " -> "
+            << stats.cellsAfter << " cells, removed " << stats.RemovedCells()
+            << ", folded " << stats.foldedOperators << " operators, threaded "
+            << stats.threadedJumps << " jumps" << std::endl;
+  if (cache != nullptr) {
+    const CacheStats& counters = cache->Stats();
+    std::cerr << "Cache: " << counters.hits << " hits, " << counters.misses
+              << " misses, " << counters.evictions << " evicted"
+              << std::endl;
+  }
+}
+
+/**
+ * @brief Lowers optimized cells to bytecode and executes them with the
+ * virtual machine the options select.
+ */
+void Execute(const std::vector<RPNCell>& cells, const RunOptions& options) {
+  Program program = BytecodeCompiler(cells).Compile();
+  if (options.useRegisterMachine) {
+    RegisterProgram lowered = RegisterCompiler(program).Compile();
+    RegisterMachine machine(lowered);
+    machine.Run();
+  } else {
+    StackMachine machine(program);
+    machine.SetJitThreshold(options.jitThreshold);
+    machine.Run();
+  }
+}
+
+}  // namespace
+
+/**
+ * @brief Compiles a program and runs it, or translates it to C++.
+ *
+ * Program flow:
+ * 1. Looks the program up in options.cache, if there is one; on a hit the
+ *    stored cells are listed and run, skipping steps 2 to 4
+ * 2. Performs lexical and syntax analysis using LexemAnalyzer and
+ *    SyntaxAnalyzer, lexing statements as the parser reaches them and
+ *    building the syntax tree
+ * 3. Performs semantic analysis of the tree using Semantic analyzer
+ * 4. Builds the RPN program from the tree and optimizes it
+ * 5. Lowers it to bytecode and executes it with the selected virtual
+ *    machine, or with options.compileOnly writes it to the program image
+ *    at options.outputPath (see ProgramImage.h)
+ *
+ * Output goes to std::cout, diagnostics to std::cerr; an error is reported
+ * on std::cout as "Error: <message>". Only programs that compile are
+ * cached, and translation to C++ bypasses the cache.
+ *
+ * @param code Source of the program; it must stay valid during the call
+ * @return int The exit status of the run: 0 on success, 1 on error
+ */
+int RunProgram(std::string_view code, const RunOptions& options) {
+  try {
+    CompileCache* cache = options.emit.empty() ? options.cache.get() : nullptr;
+    std::string key;
+    std::optional<CompiledProgram> compiled;
+    if (cache != nullptr) {
+      key = CompileCache::Key(code, options.keywords.get(),
+                              options.optimizationLevel);
+      compiled = cache->Lookup(key);
+    }
+    if (!compiled) {
+      LexemAnalyzer lexer(code, options.keywords);
+      if (options.lexThreads != 1) {
+        lexer.AnalyzeParallel(options.lexThreads);
+      }
+      // Without a parallel run the parser pulls the lexems as it goes, so a
+      // syntax error stops lexing; the tree it builds feeds the later
+      // stages.
+      SyntaxAnalyzer syntaxer(lexer);
+      syntaxer.Analyze();
+      Ast& ast = syntaxer.GetAst();
+      SemanticAnalyzer semantic(ast);
+      //semantic.Analyze();
+      RPN rpn(ast);
+      rpn.buildRPN();
+      Optimizer optimizer(rpn.getRPN());
+      compiled = CompiledProgram{rpn.getRPN(),
+                                 optimizer.Run(options.optimizationLevel),
+                                 optimizer.Stats()};
+      if (!options.emit.empty()) {
+        if (options.printStats) {
+          PrintStats(compiled->stats, nullptr);
+        }
+        // The C++ backend needs the declared types, so only this mode runs
+        // the semantic analysis.
+        semantic.Analyze();
+        std::string source = CppEmitter(compiled->cells, semantic).Emit();
+        if (options.emit == "cpp" && options.outputPath.empty()) {
+          std::cout << source;
+          return 0;
+        }
+        std::string sourcePath = options.emit == "cpp"
+                                     ? options.outputPath
+                                     : options.outputPath + ".cpp";
+        std::ofstream sourceFile(sourcePath);
+        if (!(sourceFile << source)) {
+          throw std::runtime_error("Failed to write '" + sourcePath + "'");
+        }
+        sourceFile.close();
+        if (options.emit == "binary") {
+          CppEmitter::BuildExecutable(sourcePath, options.outputPath);
+        }
+        return 0;
+      }
+      if (cache != nullptr) {
+        cache->Store(key, *compiled);
+      }
+    }
+    if (options.printStats) {
+      PrintStats(compiled->stats, cache);
+    }
+    RPN::printCells(compiled->listing);
+    std::cout << "Code analysis completed successfully!" << std::endl;
+    if (options.compileOnly) {
+      ProgramImage::Write(compiled->cells, options.outputPath);
+      return 0;
+    }
+    std::cout << "==============" << std::endl;
+    Execute(compiled->cells, options);
+    return 0;
+  } catch (const std::exception& e) {
+    std::cout << "Error: " << e.what() << std::endl;
+    return 1;
+  }
+}
+
+/**
+ * @brief Runs a program image written by RunProgram() with
+ * options.compileOnly.
+ *
+ * The image is mapped and its cells are executed as they are; only the
+ * output of the program itself is printed, without the listing.
+ *
+ * @param path Path of the image
+ * @return int The exit status of the run: 0 on success, 1 on error
+ */
+int RunImage(const std::string& path, const RunOptions& options) {
+  try {
+    ProgramImage image(path);
+    Execute(image.Cells(), options);
+    return 0;
+  } catch (const std::exception& e) {
+    std::cout << "Error: " << e.what() << std::endl;
+    return 1;
+  }
+}
@@ -0,0 +1,122 @@
+#include "Interner.h"
+#include <deque>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr size_t kInitialSlots = 1024;
+
+uint32_t NameHash(std::string_view name) {
+  uint32_t hash = 2166136261u;
+  for (char c : name) {
+    hash = (hash ^ static_cast<unsigned char>(c)) * 16777619u;
+  }
+  return hash ^ (hash >> 15);
+}
+
+/**
+ * @brief Open-addressing hash table from name to id
+ *
+ * A slot holds id + 1, 0 marks a free slot; the table is kept at most half
+ * full and doubled when it would fill up. Names live in a deque, so the
+ * views handed out by SymbolName() stay valid while the table grows.
+ */
+class SymbolTable {
+ public:
+  SymbolTable() : slots_(kInitialSlots, 0) {}
+
+  SymbolId Intern(std::string_view name, uint32_t hash, bool insert) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    size_t mask = slots_.size() - 1;
+    for (size_t slot = hash & mask;; slot = (slot + 1) & mask) {
+      uint32_t entry = slots_[slot];
+      if (entry == 0) {
+        if (!insert) {
+          return kNoSymbol;
+        }
+        SymbolId id = names_.size();
+        names_.emplace_back(name);
+        hashes_.push_back(hash);
+        slots_[slot] = id + 1;
+        if (2 * names_.size() > slots_.size()) {
+          Grow();
+        }
+        return id;
+      }
+      if (hashes_[entry - 1] == hash && names_[entry - 1] == name) {
+        return entry - 1;
+      }
+    }
+  }
+
+  std::string_view Name(SymbolId id) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return id < names_.size() ? std::string_view(names_[id])
+                              : std::string_view();
+  }
+
+  size_t Count() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return names_.size();
+  }
+
+ private:
+  std::mutex mutex_;
+  std::vector<uint32_t> slots_;
+  std::vector<uint32_t> hashes_;
+  std::deque<std::string> names_;
+
+  void Grow() {
+    std::vector<uint32_t> slots(slots_.size() * 2, 0);
+    size_t mask = slots.size() - 1;
+    for (SymbolId id = 0; id < names_.size(); ++id) {
+      size_t slot = hashes_[id] & mask;
+      while (slots[slot] != 0) {
+        slot = (slot + 1) & mask;
+      }
+      slots[slot] = id + 1;
+    }
+    slots_.swap(slots);
+  }
+};
+
+SymbolTable& Table() {
+  static SymbolTable table;
+  return table;
+}
+
+}  // namespace
+
+/**
+ * @brief Returns the id of a name, assigning the next free id the first
+ * time the name is seen.
+ */
+SymbolId InternSymbol(std::string_view name) {
+  return Table().Intern(name, NameHash(name), true);
+}
+
+/**
+ * @brief Returns the id of a name without interning it.
+ *
+ * @return SymbolId The id, kNoSymbol if the name was never interned
+ */
+SymbolId LookupSymbol(std::string_view name) {
+  return Table().Intern(name, NameHash(name), false);
+}
+
+/**
+ * @brief Returns the name an id was assigned to, an empty view for
+ * kNoSymbol.
+ */
+std::string_view SymbolName(SymbolId id) {
+  return Table().Name(id);
+}
+
+/**
+ * @brief Returns the number of interned names; every id is below it.
+ */
+size_t SymbolCount() {
+  return Table().Count();
+}
@@ -0,0 +1,407 @@
+#include "Jit.h"
+#include <cstring>
+
+#if SIGMA_HAS_JIT
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+const uint32_t kMaxJitSlots = 64;
+
+bool IsJump(OpCode op) {
+  return op == OpCode::Jump || op == OpCode::JumpIfFalse;
+}
+
+// Second opcode byte of the setcc matching a comparison of signed integers
+uint8_t SetccOpcode(OpCode op) {
+  switch (op) {
+    case OpCode::Less:
+      return 0x9C;
+    case OpCode::Greater:
+      return 0x9F;
+    case OpCode::LessEqual:
+      return 0x9E;
+    case OpCode::GreaterEqual:
+      return 0x9D;
+    case OpCode::Equal:
+      return 0x94;
+    default:
+      return 0x95;
+  }
+}
+
+}  // namespace
+
+/**
+ * @brief Takes ownership of executable pages holding a compiled function.
+ */
+NativeFunction::NativeFunction(void* memory, size_t size, uint32_t frameSize,
+                               std::vector<uint32_t> globals)
+    : memory_(memory),
+      size_(size),
+      frameSize_(frameSize),
+      globals_(std::move(globals)) {}
+
+NativeFunction::~NativeFunction() {
+#if SIGMA_HAS_JIT
+  munmap(memory_, size_);
+#endif
+}
+
+/**
+ * @brief Runs the compiled function.
+ *
+ * @param slots FrameSize() frame slots, arguments first, followed by the
+ *        globals listed in Globals(); updated in place
+ * @return int64_t The returned value, 0 when the function ends without
+ *         return
+ */
+int64_t NativeFunction::Invoke(int64_t* slots) const {
+  return reinterpret_cast<Entry>(memory_)(slots);
+}
+
+/**
+ * @brief Constructs a JIT compiler for one function of a program.
+ *
+ * @param program Program produced by BytecodeCompiler::Compile()
+ * @param function Index into Program::functions
+ */
+JitCompiler::JitCompiler(const Program& program, uint32_t function)
+    : program_(program), function_(program.functions[function]) {}
+
+/**
+ * @brief Translates the function to machine code.
+ *
+ * @return std::unique_ptr<NativeFunction> The compiled function, or nullptr
+ *         if it uses anything the JIT does not handle or the target has no
+ *         JIT support
+ */
+std::unique_ptr<NativeFunction> JitCompiler::Compile() {
+  if (!SIGMA_JIT_ENABLED || !FindEnd() || !IsSupported() || !Verify()) {
+    return nullptr;
+  }
+
+  std::vector<size_t> offsets(end_ - function_.entry + 2);
+  // push rbp; mov rbp, rsp
+  EmitBytes({0x55, 0x48, 0x89, 0xE5});
+  for (uint32_t pc = function_.entry; pc <= end_; ++pc) {
+    offsets[pc - function_.entry] = code_.size();
+    EmitInstruction(program_.code[pc]);
+  }
+  offsets.back() = code_.size();
+  // mov rsp, rbp; pop rbp; ret
+  EmitBytes({0x48, 0x89, 0xEC, 0x5D, 0xC3});
+
+  for (const auto& [at, target] : jumpFixups_) {
+    int32_t relative = static_cast<int32_t>(offsets[target - function_.entry]) -
+                       static_cast<int32_t>(at + 4);
+    std::memcpy(&code_[at], &relative, sizeof(relative));
+  }
+  return Install();
+}
+
+/**
+ * @brief Finds the Leave closing the function body.
+ */
+bool JitCompiler::FindEnd() {
+  for (uint32_t pc = function_.entry; pc < program_.code.size(); ++pc) {
+    if (program_.code[pc].op == OpCode::Leave) {
+      end_ = pc;
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * @brief Checks that every instruction of the body has a template.
+ */
+bool JitCompiler::IsSupported() const {
+  if (function_.frameSize > kMaxJitSlots) {
+    return false;
+  }
+  for (uint32_t pc = function_.entry; pc <= end_; ++pc) {
+    const Instruction& instruction = program_.code[pc];
+    switch (instruction.op) {
+      case OpCode::PushConst:
+        if (!program_.constants[instruction.arg].IsInt()) {
+          return false;
+        }
+        break;
+      case OpCode::Jump:
+      case OpCode::JumpIfFalse:
+        if (instruction.arg < function_.entry || instruction.arg > end_) {
+          return false;
+        }
+        break;
+      case OpCode::Div:
+      case OpCode::Mod:
+      case OpCode::Call:
+      case OpCode::Print:
+        return false;
+      default:
+        break;
+    }
+  }
+  return true;
+}
+
+/**
+ * @brief Checks the body by abstract interpretation: the operand stack has
+ * the same depth on every path into an instruction and never underflows,
+ * and no frame slot is read before it is assigned on every path.
+ */
+bool JitCompiler::Verify() const {
+  size_t count = end_ - function_.entry + 1;
+  std::vector<int> depth(count, -1);
+  std::vector<uint64_t> assigned(count, ~0ull);
+  depth[0] = 0;
+  assigned[0] = function_.arity == 64 ? ~0ull : (1ull << function_.arity) - 1;
+
+  std::vector<uint32_t> worklist = {0};
+  while (!worklist.empty()) {
+    uint32_t index = worklist.back();
+    worklist.pop_back();
+    const Instruction& instruction = program_.code[function_.entry + index];
+    int stack = depth[index];
+    uint64_t slots = assigned[index];
+    std::vector<uint32_t> successors;
+    switch (instruction.op) {
+      case OpCode::LoadLocal:
+        if (!(slots >> instruction.arg & 1)) {
+          return false;
+        }
+        [[fallthrough]];
+      case OpCode::PushConst:
+      case OpCode::LoadGlobal:
+        ++stack;
+        successors.push_back(index + 1);
+        break;
+      case OpCode::StoreLocal:
+        slots |= 1ull << instruction.arg;
+        [[fallthrough]];
+      case OpCode::StoreGlobal:
+      case OpCode::Return:
+        if (--stack < 0) {
+          return false;
+        }
+        if (instruction.op != OpCode::Return) {
+          successors.push_back(index + 1);
+        }
+        break;
+      case OpCode::Add:
+      case OpCode::Sub:
+      case OpCode::Mul:
+      case OpCode::Less:
+      case OpCode::Greater:
+      case OpCode::LessEqual:
+      case OpCode::GreaterEqual:
+      case OpCode::Equal:
+      case OpCode::NotEqual:
+      case OpCode::And:
+      case OpCode::Or:
+        if (--stack < 1) {
+          return false;
+        }
+        successors.push_back(index + 1);
+        break;
+      case OpCode::Not:
+      case OpCode::Negate:
+        if (stack < 1) {
+          return false;
+        }
+        successors.push_back(index + 1);
+        break;
+      case OpCode::JumpIfFalse:
+        if (--stack < 0) {
+          return false;
+        }
+        successors.push_back(index + 1);
+        [[fallthrough]];
+      case OpCode::Jump:
+        successors.push_back(instruction.arg - function_.entry);
+        break;
+      default:
+        break;
+    }
+    for (uint32_t next : successors) {
+      if (depth[next] < 0) {
+        depth[next] = stack;
+        assigned[next] = slots;
+        worklist.push_back(next);
+      } else if (depth[next] != stack) {
+        return false;
+      } else if ((assigned[next] & slots) != assigned[next]) {
+        assigned[next] &= slots;
+        worklist.push_back(next);
+      }
+    }
+  }
+  return true;
+}
+
+/**
+ * @brief Emits the template of one instruction. rdi holds the slot array,
+ * the operand stack lives on the native stack.
+ */
+void JitCompiler::EmitInstruction(const Instruction& instruction) {
+  switch (instruction.op) {
+    case OpCode::PushConst:
+      // mov rax, imm64; push rax
+      EmitBytes({0x48, 0xB8});
+      Emit64(program_.constants[instruction.arg].AsInt());
+      EmitBytes({0x50});
+      break;
+    case OpCode::LoadLocal:
+    case OpCode::LoadGlobal: {
+      uint32_t slot = instruction.op == OpCode::LoadLocal
+                          ? instruction.arg
+                          : GlobalSlot(instruction.arg);
+      // push qword [rdi + slot * 8]
+      EmitBytes({0xFF, 0xB7});
+      Emit32(slot * 8);
+      break;
+    }
+    case OpCode::StoreLocal:
+    case OpCode::StoreGlobal: {
+      uint32_t slot = instruction.op == OpCode::StoreLocal
+                          ? instruction.arg
+                          : GlobalSlot(instruction.arg);
+      // pop rax; mov [rdi + slot * 8], rax
+      EmitBytes({0x58, 0x48, 0x89, 0x87});
+      Emit32(slot * 8);
+      break;
+    }
+    case OpCode::Add:
+      // pop rcx; pop rax; add rax, rcx; push rax
+      EmitBytes({0x59, 0x58, 0x48, 0x01, 0xC8, 0x50});
+      break;
+    case OpCode::Sub:
+      // pop rcx; pop rax; sub rax, rcx; push rax
+      EmitBytes({0x59, 0x58, 0x48, 0x29, 0xC8, 0x50});
+      break;
+    case OpCode::Mul:
+      // pop rcx; pop rax; imul rax, rcx; push rax
+      EmitBytes({0x59, 0x58, 0x48, 0x0F, 0xAF, 0xC1, 0x50});
+      break;
+    case OpCode::Less:
+    case OpCode::Greater:
+    case OpCode::LessEqual:
+    case OpCode::GreaterEqual:
+    case OpCode::Equal:
+    case OpCode::NotEqual:
+      // pop rcx; pop rax; cmp rax, rcx; setcc al; movzx eax, al; push rax
+      EmitBytes({0x59, 0x58, 0x48, 0x39, 0xC8, 0x0F,
+                 SetccOpcode(instruction.op), 0xC0, 0x0F, 0xB6, 0xC0, 0x50});
+      break;
+    case OpCode::And:
+    case OpCode::Or:
+      // pop rcx; pop rax; test rax, rax; setne al; test rcx, rcx;
+      // setne cl; and/or al, cl; movzx eax, al; push rax
+      EmitBytes({0x59, 0x58, 0x48, 0x85, 0xC0, 0x0F, 0x95, 0xC0, 0x48, 0x85,
+                 0xC9, 0x0F, 0x95, 0xC1,
+                 static_cast<uint8_t>(instruction.op == OpCode::And ? 0x20
+                                                                    : 0x08),
+                 0xC8, 0x0F, 0xB6, 0xC0, 0x50});
+      break;
+    case OpCode::Not:
+      // pop rax; test rax, rax; sete al; movzx eax, al; push rax
+      EmitBytes({0x58, 0x48, 0x85, 0xC0, 0x0F, 0x94, 0xC0, 0x0F, 0xB6, 0xC0,
+                 0x50});
+      break;
+    case OpCode::Negate:
+      // pop rax; neg rax; push rax
+      EmitBytes({0x58, 0x48, 0xF7, 0xD8, 0x50});
+      break;
+    case OpCode::Jump:
+      EmitJump({0xE9}, instruction.arg);
+      break;
+    case OpCode::JumpIfFalse:
+      // pop rax; test rax, rax; jz target
+      EmitBytes({0x58, 0x48, 0x85, 0xC0});
+      EmitJump({0x0F, 0x84}, instruction.arg);
+      break;
+    case OpCode::Return:
+      // pop rax; jmp epilogue
+      EmitBytes({0x58});
+      EmitJump({0xE9}, end_ + 1);
+      break;
+    case OpCode::Leave:
+      // xor eax, eax; the epilogue follows
+      EmitBytes({0x31, 0xC0});
+      break;
+    default:
+      break;
+  }
+}
+
+/**
+ * @brief Returns the slot holding the copy of a global, allocating it after
+ * the frame slots on first use.
+ */
+uint32_t JitCompiler::GlobalSlot(uint32_t global) {
+  auto it = globalSlots_.find(global);
+  if (it != globalSlots_.end()) {
+    return it->second;
+  }
+  uint32_t slot = function_.frameSize + globals_.size();
+  globalSlots_[global] = slot;
+  globals_.push_back(global);
+  return slot;
+}
+
+void JitCompiler::EmitBytes(std::initializer_list<uint8_t> bytes) {
+  code_.insert(code_.end(), bytes);
+}
+
+/**
+ * @brief Emits a jump with a 32-bit displacement patched in Compile().
+ *
+ * @param target Instruction index, end + 1 for the epilogue
+ */
+void JitCompiler::EmitJump(std::initializer_list<uint8_t> opcode,
+                           uint32_t target) {
+  EmitBytes(opcode);
+  jumpFixups_.emplace_back(code_.size(), target);
+  Emit32(0);
+}
+
+void JitCompiler::Emit32(uint32_t value) {
+  uint8_t bytes[sizeof(value)];
+  std::memcpy(bytes, &value, sizeof(value));
+  code_.insert(code_.end(), bytes, bytes + sizeof(value));
+}
+
+void JitCompiler::Emit64(uint64_t value) {
+  uint8_t bytes[sizeof(value)];
+  std::memcpy(bytes, &value, sizeof(value));
+  code_.insert(code_.end(), bytes, bytes + sizeof(value));
+}
+
+/**
+ * @brief Copies the code to fresh pages and makes them executable.
+ *
+ * The pages are never writable and executable at the same time.
+ */
+std::unique_ptr<NativeFunction> JitCompiler::Install() const {
+#if SIGMA_HAS_JIT
+  size_t page = sysconf(_SC_PAGESIZE);
+  size_t size = (code_.size() + page - 1) / page * page;
+  void* memory = mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (memory == MAP_FAILED) {
+    return nullptr;
+  }
+  std::memcpy(memory, code_.data(), code_.size());
+  if (mprotect(memory, size, PROT_READ | PROT_EXEC) != 0) {
+    munmap(memory, size);
+    return nullptr;
+  }
+  return std::make_unique<NativeFunction>(memory, size, function_.frameSize,
+                                          globals_);
+#else
+  return nullptr;
+#endif
+}
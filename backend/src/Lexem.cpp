@@ -1,17 +1,128 @@
 #include "../include/Lexem.h"
 #include <iostream>
 
-void Lexem::set_text(std::string txt) {
+/**
+ * @brief Constructs a lexem and interns its keyword, symbol or name id.
+ */
+Lexem::Lexem(LexemType type, std::string_view text, int s, int e, int l)
+    : s_(s), e_(e), type_(type), line_(l) {
+  set_text(text);
+}
+
+/**
+ * @brief Sets the text of the lexem and re-interns its keyword, symbol or
+ * name id.
+ */
+void Lexem::set_text(std::string_view txt) {
   text_ = txt;
+  id_ = kNoSymbol;
+  keyword_ = Keyword::None;
+  symbol_ = Symbol::None;
+  if (type_ == LexemType::IDENTIFIER) {
+    id_ = InternSymbol(text_);
+  } else if (type_ == LexemType::KEYWORD) {
+    keyword_ = static_cast<Keyword>(FindDefaultKeyword(text_));
+  } else if (type_ == LexemType::OPERATOR || type_ == LexemType::REL_OP ||
+             type_ == LexemType::BRACKET) {
+    symbol_ = FindSymbol(text_);
+  }
 }
 
 /**
- * @brief Returns the string representation of the lexem type.
+ * @brief Moves the lexem after an edit of the source in front of it.
+ *
+ * The interned ids are kept, so the text must be the same characters at
+ * their new place.
+ *
+ * @param text The text of the lexem in the edited source
+ * @param offset Number of bytes the lexem moved by
+ * @param lines Number of lines the lexem moved by
+ */
+void Lexem::relocate(std::string_view txt, int offset, int lines) {
+  text_ = txt;
+  s_ += offset;
+  e_ += offset;
+  line_ += lines;
+}
+
+/**
+ * @brief Returns the symbol id of an operator or bracket text.
+ *
+ * @return Symbol The symbol, Symbol::None if the text is not one
+ */
+Symbol FindSymbol(std::string_view text) {
+  if (text.size() == 2 && text[1] == '=') {
+    switch (text[0]) {
+      case '=':
+        return Symbol::Equal;
+      case '!':
+        return Symbol::NotEqual;
+      case '<':
+        return Symbol::LessEqual;
+      case '>':
+        return Symbol::GreaterEqual;
+    }
+    return Symbol::None;
+  }
+  if (text == "&&") {
+    return Symbol::And;
+  }
+  if (text == "||") {
+    return Symbol::Or;
+  }
+  if (text.size() != 1) {
+    return Symbol::None;
+  }
+  switch (text[0]) {
+    case '(':
+      return Symbol::LeftParen;
+    case ')':
+      return Symbol::RightParen;
+    case '{':
+      return Symbol::LeftBrace;
+    case '}':
+      return Symbol::RightBrace;
+    case '[':
+      return Symbol::LeftBracket;
+    case ']':
+      return Symbol::RightBracket;
+    case ',':
+      return Symbol::Comma;
+    case ';':
+      return Symbol::Semicolon;
+    case ':':
+      return Symbol::Colon;
+    case '=':
+      return Symbol::Assign;
+    case '+':
+      return Symbol::Plus;
+    case '-':
+      return Symbol::Minus;
+    case '*':
+      return Symbol::Star;
+    case '/':
+      return Symbol::Slash;
+    case '%':
+      return Symbol::Percent;
+    case '<':
+      return Symbol::Less;
+    case '>':
+      return Symbol::Greater;
+    case '!':
+      return Symbol::Not;
+  }
+  return Symbol::None;
+}
+
+/**
+ * @brief Returns the string representation of the lexem type, for
+ * diagnostics and PrintLexems.
  * 
  * @return std::string One of the following:
  *         - "KEYWORD" for keywords
  *         - "NUMBER" for numeric values
  *         - "EOS" for end of statement
+ *         - "REL_OP" for relational operators
  *         - "OPERATOR" for operators
  *         - "STRING" for string literals
  *         - "IDENTIFIER" for variable/function names
@@ -23,7 +134,7 @@ void Lexem::set_text(std::string txt) {
  *         - "EOC" for end of code
  *         - "UNKNOWN" if type is not recognized
  */
-std::string Lexem::get_type() const {
+std::string Lexem::get_type_name() const {
   if (type_ == LexemType::KEYWORD) {
     return "KEYWORD";
   }
@@ -33,6 +144,9 @@ std::string Lexem::get_type() const {
   if (type_ == LexemType::EOS) {
     return "EOS";
   }
+  if (type_ == LexemType::REL_OP) {
+    return "REL_OP";
+  }
   if (type_ == LexemType::OPERATOR) {
     return "OPERATOR";
   }
@@ -69,7 +183,7 @@ std::string Lexem::get_type() const {
 /**
  * @brief Получает текст лексемы.
  */
-std::string Lexem::get_text() const {
+std::string_view Lexem::get_text() const {
   return text_;
 }
 
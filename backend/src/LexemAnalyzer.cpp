@@ -1,39 +1,171 @@
 #include "../include/LexemAnalyzer.h"
+#include <algorithm>
 #include <cctype>
+#include <exception>
 #include <fstream>
+#include <functional>
 #include <iostream>
+#include <numeric>
 #include <stack>
 #include <stdexcept>
+#include <thread>
 #include "../include/Lexem.h"
 
+namespace {
+
+/**
+ * @brief Replaces v[from, to) with the elements appended to v from index
+ * appended on, which are removed from the end
+ */
+template <typename T>
+void Splice(std::vector<T>& v, size_t from, size_t to, size_t appended) {
+  std::vector<T> added(std::make_move_iterator(v.begin() + appended),
+                       std::make_move_iterator(v.end()));
+  v.erase(v.begin() + appended, v.end());
+  size_t common = std::min(added.size(), to - from);
+  std::move(added.begin(), added.begin() + common, v.begin() + from);
+  v.erase(v.begin() + from + common, v.begin() + to);
+  v.insert(v.begin() + from + common,
+           std::make_move_iterator(added.begin() + common),
+           std::make_move_iterator(added.end()));
+}
+
+// Parts smaller than this are not worth a thread
+constexpr size_t kMinPartBytes = 1 << 18;
+
+/**
+ * @brief Calls task(0) .. task(count - 1) on count threads, one of them the
+ * calling thread; task must not throw
+ */
+template <typename Task>
+void RunParallel(size_t count, const Task& task) {
+  std::vector<std::thread> workers;
+  for (size_t i = 1; i < count; ++i) {
+    workers.emplace_back(task, i);
+  }
+  task(0);
+  for (std::thread& worker : workers) {
+    worker.join();
+  }
+}
+
+}  // namespace
+
 /**
  * @brief Constructor for the LexemAnalyzer class
  * 
- * @param code String containing the source code to be analyzed
- * @param pathToKeywords Path to the file containing keywords
+ * @param code Source code to be analyzed; it is not copied and must outlive
+ * the analyzer and its lexems
+ * @param pathToKeywords Path to a file with a custom keyword set; empty to
+ * use the built-in keywords
  * 
  * @throws std::runtime_error If the keywords file cannot be opened
- * 
+ */
+LexemAnalyzer::LexemAnalyzer(std::string_view code,
+                             const std::string& pathToKeywords)
+    : LexemAnalyzer(code, pathToKeywords.empty()
+                              ? nullptr
+                              : LoadKeywords(pathToKeywords)) {}
+
+/**
+ * @brief Constructor for the LexemAnalyzer class
+ *
+ * @param code Source code to be analyzed; it is not copied and must outlive
+ * the analyzer and its lexems
+ * @param keywords Custom keyword set from LoadKeywords(), shared with other
+ * analyzers; null to use the built-in keywords
+ *
  * @details Initializes a new LexemAnalyzer instance with the given source code.
  * Sets up initial state with:
  * - Empty current character
- * - Zero index and position
+ * - The first character read, ready for Next()
  * - Initial indent level of 0
- * - Loads keywords from the specified file into keywords_ container
  */
-LexemAnalyzer::LexemAnalyzer(const std::string& code,
-                             const std::string& pathToKeywords)
-    : code_(code), ch_('\0'), index_(0), currentPosition_(0) {
+LexemAnalyzer::LexemAnalyzer(std::string_view code,
+                             std::shared_ptr<const bor> keywords)
+    : ch_('\0'),
+      code_(code),
+      index_(0),
+      currentPosition_(0),
+      keywords_(std::move(keywords)),
+      scan_(ActiveScanKernels()) {
   indentStack_.push_back(0);
   curLine_ = 1;
-  std::ifstream keywords(pathToKeywords);
-  if (!keywords.is_open()) {
-    throw std::runtime_error("Failed to open file '../test/workword.txt'");
+  GetNextChar();
+}
+
+/**
+ * @brief Loads a custom keyword set, one whitespace-separated word per
+ * keyword, so that it can be shared by every analyzer that uses it.
+ *
+ * @throws std::runtime_error If the keywords file cannot be opened
+ */
+std::shared_ptr<const bor> LexemAnalyzer::LoadKeywords(
+    const std::string& path) {
+  std::ifstream file(path);
+  if (!file.is_open()) {
+    throw std::runtime_error("Failed to open keywords file '" + path + "'");
   }
+  auto keywords = std::make_shared<bor>();
   std::string word;
-  while (keywords >> word) {
-    keywords_.add(word);
+  while (file >> word) {
+    keywords->add(word);
+  }
+  return keywords;
+}
+
+/**
+ * @brief Checks whether a word is a keyword, using the custom keyword set
+ * if one was loaded and the built-in table otherwise
+ */
+bool LexemAnalyzer::IsKeyword(std::string_view word) const {
+  if (keywords_) {
+    return keywords_->find(word.data(), word.size()) >= 0;
+  }
+  return FindDefaultKeyword(word) >= 0;
+}
+
+/**
+ * @brief Reads a run of letters, digits and underscores starting at the
+ * current character
+ *
+ * @return std::string_view View of the run in the source, empty if the
+ * current character cannot start one
+ */
+std::string_view LexemAnalyzer::ScanWord() {
+  size_t begin = Position();
+  size_t end = scan_.identifier(code_.data(), begin, code_.size());
+  SkipTo(end);
+  return code_.substr(begin, end - begin);
+}
+
+/**
+ * @brief Returns the offset of the current character in the source, or the
+ * size of the source once the end was reached
+ */
+size_t LexemAnalyzer::Position() const {
+  return ch_ == '\0' ? code_.size() : index_ - 1;
+}
+
+/**
+ * @brief Moves to the character at the given offset, with the same effect
+ * as calling GetNextChar() once per skipped character
+ *
+ * Used to consume a whole span found by one of the scan kernels.
+ *
+ * @param position Offset of the new current character; the end of the
+ * source if it is past the last character
+ */
+void LexemAnalyzer::SkipTo(size_t position) {
+  size_t current = Position();
+  if (position <= current || current == code_.size()) {
+    return;
   }
+  size_t last = std::min(position, code_.size() - 1);
+  curLine_ += std::count(code_.begin() + current, code_.begin() + last, '\n');
+  index_ = last + 1;
+  currentPosition_ = index_;
+  ch_ = position < code_.size() ? code_[position] : '\0';
 }
 
 /**
@@ -84,34 +216,23 @@ void LexemAnalyzer::SkipWhitespace() {
         lexems_.emplace_back(
             Lexem(LexemType::NEWLINE, "\\n", index_ - 1, index_, curLine_));
         GetNextChar();
-        int indent = 0;
-        while (ch_ == ' ') {
-          indent++;
-          GetNextChar();
-        }
-        HandleIndentation(indent);
+        size_t lineStart = Position();
+        size_t indentEnd = scan_.spaces(code_.data(), lineStart, code_.size());
+        SkipTo(indentEnd);
+        HandleIndentation(static_cast<int>(indentEnd - lineStart));
         continue;
       }
-      GetNextChar();
+      SkipTo(scan_.blanks(code_.data(), Position(), code_.size()));
     }
     if (ch_ == '/' && index_ < code_.length() && code_[index_] == '/') {
-      while (ch_ != '\n' && ch_ != '\0') {
-        GetNextChar();
-      }
+      SkipTo(code_.find('\n', Position()));
       continue;
     }
     if (ch_ == '/' && index_ < code_.length() && code_[index_] == '*') {
       GetNextChar();
       GetNextChar();
-
-      while (ch_ != '\0') {
-        if (ch_ == '*' && index_ < code_.length() && code_[index_] == '/') {
-          GetNextChar();
-          GetNextChar();
-          break;
-        }
-        GetNextChar();
-      }
+      size_t close = code_.find("*/", Position());
+      SkipTo(close == std::string_view::npos ? code_.size() : close + 2);
       continue;
     }
 
@@ -170,10 +291,447 @@ void LexemAnalyzer::HandleIndentation(int currentIndent) {
  * The analysis results are stored in the lexems_ container.
  */
 void LexemAnalyzer::Analyze() {
+  Reset();
+  lexems_.reserve(code_.size() / 8);
   GetNextChar();
-  AnalyzeProgram();
+  try {
+    AnalyzeProgram();
+  } catch (...) {
+    // A partial run cannot be resumed by Reanalyze()
+    checkpoints_.clear();
+    throw;
+  }
   lexems_.emplace_back(
-      Lexem(LexemType::EOC, std::string("eof"), index_, index_ + 1, curLine_));
+      Lexem(LexemType::EOC, "eof", index_, index_ + 1, curLine_));
+  lexedAll_ = true;
+}
+
+/**
+ * @brief Performs lexical analysis with up to the given number of threads
+ *
+ * The source is split into parts starting at top-level "def" lines, which
+ * are lexed concurrently, each from a fresh indentation stack, and then
+ * joined in order. A part is lexed without knowing how the previous one
+ * ends, so lexing of the previous part continues into it until it reaches
+ * one of the part's checkpoints with the same offset and indentation
+ * stack; the part is used from that checkpoint on. A part that is never
+ * reached this way, e.g. because its "def" line is inside a string or a
+ * comment, is lexed again by the previous one. The lexems and checkpoints
+ * are therefore identical to those of Analyze(), and errors of a part are
+ * only reported if the part is used.
+ *
+ * Sources too small to give every thread kMinPartBytes are lexed on the
+ * calling thread.
+ *
+ * @param threads Maximum number of threads; 0 uses one per hardware thread
+ *
+ * @throws std::runtime_error On the same errors as Analyze()
+ */
+void LexemAnalyzer::AnalyzeParallel(unsigned threads) {
+  if (threads == 0) {
+    threads = std::max(1u, std::thread::hardware_concurrency());
+  }
+  std::vector<size_t> starts = SplitAtTopLevel(threads);
+  if (starts.size() < 2) {
+    Analyze();
+    return;
+  }
+  Reset();
+  size_t count = starts.size();
+  starts.push_back(code_.size());
+
+  std::vector<size_t> lines(count + 1, 0);
+  RunParallel(count, [&](size_t i) {
+    lines[i + 1] = std::count(code_.begin() + starts[i],
+                              code_.begin() + starts[i + 1], '\n');
+  });
+  lines[0] = 1;
+  std::partial_sum(lines.begin(), lines.end(), lines.begin());
+
+  // The lexems of the first part are taken over, the rest appended to them
+  std::vector<LexemAnalyzer> parts(count, *this);
+  parts[0].lexems_.reserve(code_.size() / 8);
+  std::vector<std::exception_ptr> errors(count);
+  RunParallel(count, [&](size_t i) {
+    try {
+      size_t end = i + 1 < count ? starts[i + 1] : std::string_view::npos;
+      parts[i].AnalyzePart(starts[i], end, lines[i]);
+    } catch (...) {
+      errors[i] = std::current_exception();
+    }
+  });
+
+  if (errors[0]) {
+    std::rethrow_exception(errors[0]);
+  }
+  AppendPart(parts[0], 0);
+  LexemAnalyzer* last = &parts[0];
+  for (size_t i = 1; i < count; ++i) {
+    Resync resync;
+    resync.run = &parts[i];
+    resync.first = 0;
+    resync.checkpoints = parts[i].checkpoints_.size();
+    resync.end = starts[i];
+    resync.delta = 0;
+    resync.match = resync.checkpoints;
+    last->stop_ = i + 1 < count ? starts[i + 1] : std::string_view::npos;
+    bool resynced = false;
+    try {
+      resynced = last->AnalyzeProgram(&resync);
+    } catch (...) {
+      checkpoints_.clear();
+      throw;
+    }
+    AppendPart(*last, 0);
+    if (resynced) {
+      last = &parts[i];
+      if (errors[i]) {
+        checkpoints_.clear();
+        std::rethrow_exception(errors[i]);
+      }
+      AppendPart(*last, resync.match);
+    }
+  }
+  index_ = last->index_;
+  currentPosition_ = last->currentPosition_;
+  ch_ = last->ch_;
+  curLine_ = last->curLine_;
+  indentStack_ = last->indentStack_;
+  lexems_.emplace_back(
+      Lexem(LexemType::EOC, "eof", index_, index_ + 1, curLine_));
+  lexedAll_ = true;
+}
+
+/**
+ * @brief Picks the starts of up to parts pieces of the source, each at the
+ * beginning of a line starting with "def" and at least kMinPartBytes apart
+ *
+ * @return std::vector<size_t> Offsets of the pieces, the first one is 0
+ */
+std::vector<size_t> LexemAnalyzer::SplitAtTopLevel(unsigned parts) const {
+  std::vector<size_t> starts = {0};
+  parts = std::min<size_t>(parts, code_.size() / kMinPartBytes);
+  for (unsigned i = 1; i < parts; ++i) {
+    size_t target = code_.size() / parts * i;
+    if (target < starts.back() + kMinPartBytes) {
+      continue;
+    }
+    size_t found = code_.find("\ndef", target - 1);
+    while (found != std::string_view::npos && found + 4 < code_.size() &&
+           code_[found + 4] != ' ' && code_[found + 4] != '\t') {
+      found = code_.find("\ndef", found + 1);
+    }
+    if (found == std::string_view::npos || found + 4 >= code_.size()) {
+      break;
+    }
+    starts.push_back(found + 1);
+  }
+  return starts;
+}
+
+/**
+ * @brief Lexes one part of the source for AnalyzeParallel(), assuming it
+ * starts a top-level statement
+ *
+ * @param begin Offset of the first character of the part
+ * @param end Offset of the next part; lexing stops at the first statement
+ * that starts there or later
+ * @param line Line number of the first character
+ */
+void LexemAnalyzer::AnalyzePart(size_t begin, size_t end, size_t line) {
+  Reset();
+  lexems_.reserve((std::min(end, code_.size()) - begin) / 8);
+  curLine_ = line;
+  index_ = begin + 1;
+  currentPosition_ = index_;
+  ch_ = code_[begin];
+  stop_ = end;
+  AnalyzeProgram();
+}
+
+/**
+ * @brief Moves the lexems and checkpoints of a part behind the ones
+ * collected so far
+ *
+ * @param part The part
+ * @param from Index of the first checkpoint of the part to take; the
+ * lexems in front of it are dropped
+ */
+void LexemAnalyzer::AppendPart(LexemAnalyzer& part, size_t from) {
+  size_t lexemFrom = from == 0 ? 0 : part.checkpoints_[from].lexem;
+  size_t indentFrom = from == 0 ? 0 : part.checkpoints_[from].indentBegin;
+  size_t lexemBase = lexems_.size() - lexemFrom;
+  size_t indentBase = checkpointIndents_.size() - indentFrom;
+  if (lexems_.empty() && from == 0) {
+    lexems_.swap(part.lexems_);
+  } else {
+    lexems_.insert(lexems_.end(), part.lexems_.begin() + lexemFrom,
+                   part.lexems_.end());
+  }
+  for (size_t i = from; i < part.checkpoints_.size(); ++i) {
+    Checkpoint c = part.checkpoints_[i];
+    c.lexem += lexemBase;
+    c.indentBegin += indentBase;
+    checkpoints_.push_back(c);
+  }
+  checkpointIndents_.insert(checkpointIndents_.end(),
+                            part.checkpointIndents_.begin() + indentFrom,
+                            part.checkpointIndents_.end());
+  part.lexems_.clear();
+  part.checkpoints_.clear();
+  part.checkpointIndents_.clear();
+}
+
+/**
+ * @brief Lexes the source again after an edit, reusing the lexems of the
+ * previous run outside the edited statements
+ *
+ * Lexing restarts at the last checkpoint whose lexems cannot depend on the
+ * edited bytes and stops at the first checkpoint past the edit that has the
+ * same offset and indentation stack as one of the previous run. From there
+ * the old lexems would come out unchanged, so they are kept and only moved
+ * to their new offsets and lines. INDENT and DEDENT lexems of the re-lexed
+ * statements are regenerated from the restored indentation stack. Without
+ * a previous run this is the same as Analyze().
+ *
+ * @param code The edited source; like the original one it must outlive the
+ * analyzer and its lexems, and it may live in a different buffer
+ * @param begin Offset of the edit
+ * @param removed Number of bytes replaced at begin in the previous source
+ * @param inserted Number of bytes that replaced them in code
+ *
+ * @throws std::runtime_error If the edit does not match the sizes of the
+ * sources, or on the same errors as Analyze(); the next call after an error
+ * lexes its whole source
+ */
+void LexemAnalyzer::Reanalyze(std::string_view code, size_t begin,
+                              size_t removed, size_t inserted) {
+  if (begin + removed > code_.size() ||
+      code.size() + removed != code_.size() + inserted) {
+    throw std::runtime_error("Edit does not match the analyzed source");
+  }
+  // The lexems in front of a checkpoint may depend on the character after
+  // its offset (a '/' that does not start a comment), but not beyond.
+  auto after = std::partition_point(
+      checkpoints_.begin(), checkpoints_.end(),
+      [begin](const Checkpoint& c) { return c.offset + 2 <= begin; });
+  if (after == checkpoints_.begin()) {
+    code_ = code;
+    Analyze();
+    return;
+  }
+
+  // The new lexems and checkpoints are appended behind the old ones and
+  // spliced into place once lexing stops.
+  std::string_view previousCode = code_;
+  size_t restart = after - checkpoints_.begin() - 1;
+  size_t oldLexems = lexems_.size();
+  size_t oldCheckpoints = checkpoints_.size();
+  size_t oldIndents = checkpointIndents_.size();
+  Resync resync;
+  resync.run = this;
+  resync.first = restart + 1;
+  resync.checkpoints = oldCheckpoints;
+  resync.end = begin + inserted;
+  resync.delta = static_cast<long>(inserted) - static_cast<long>(removed);
+  resync.match = oldCheckpoints;
+  const Checkpoint start = checkpoints_[restart];
+  indentStack_.assign(
+      checkpointIndents_.begin() + start.indentBegin,
+      checkpointIndents_.begin() + start.indentBegin + start.indentDepth);
+  code_ = code;
+  curLine_ = start.line;
+  index_ = start.offset + 1;
+  currentPosition_ = index_;
+  ch_ = code_[start.offset];
+  try {
+    if (!AnalyzeProgram(&resync)) {
+      lexems_.emplace_back(
+          Lexem(LexemType::EOC, "eof", index_, index_ + 1, curLine_));
+    }
+  } catch (...) {
+    checkpoints_.clear();
+    throw;
+  }
+
+  bool resynced = resync.match < oldCheckpoints;
+  const Checkpoint* match = resynced ? &checkpoints_[resync.match] : nullptr;
+  size_t lexemEnd = resynced ? match->lexem : oldLexems;
+  size_t indentEnd = resynced ? match->indentBegin : oldIndents;
+  long lines = resynced ? static_cast<long>(curLine_) -
+                              static_cast<long>(match->line)
+                        : 0;
+  size_t newLexems = lexems_.size() - oldLexems;
+  size_t newIndents = checkpointIndents_.size() - oldIndents;
+  for (size_t i = oldCheckpoints; i < checkpoints_.size(); ++i) {
+    checkpoints_[i].lexem += start.lexem - oldLexems;
+    checkpoints_[i].indentBegin += start.indentBegin - oldIndents;
+  }
+  for (size_t i = resync.match; i < oldCheckpoints; ++i) {
+    Checkpoint& c = checkpoints_[i];
+    c.offset += resync.delta;
+    c.lexem += start.lexem + newLexems - lexemEnd;
+    c.line += lines;
+    c.indentBegin += start.indentBegin + newIndents - indentEnd;
+  }
+  Splice(checkpoints_, restart, resync.match, oldCheckpoints);
+  Splice(checkpointIndents_, start.indentBegin, indentEnd, oldIndents);
+  Splice(lexems_, start.lexem, lexemEnd, oldLexems);
+
+  bool moved = code_.data() != previousCode.data();
+  if (moved) {
+    for (size_t i = 0; i < start.lexem; ++i) {
+      lexems_[i].relocate(Rebase(lexems_[i].get_text(), previousCode, 0), 0,
+                          0);
+    }
+  }
+  if (moved || resync.delta != 0 || lines != 0) {
+    for (size_t i = start.lexem + newLexems; i < lexems_.size(); ++i) {
+      Lexem& lexem = lexems_[i];
+      lexem.relocate(Rebase(lexem.get_text(), previousCode, resync.delta),
+                     resync.delta, lines);
+    }
+  }
+  index_ = code_.size();
+  currentPosition_ = index_;
+  ch_ = '\0';
+  curLine_ = lexems_.back().get_line();
+  pulled_ = 0;
+  lexedAll_ = true;
+}
+
+/**
+ * @brief Clears the lexems and checkpoints and rewinds to the start of the
+ * source
+ */
+void LexemAnalyzer::Reset() {
+  ch_ = '\0';
+  index_ = 0;
+  currentPosition_ = 0;
+  curLine_ = 1;
+  indentStack_.assign(1, 0);
+  lexems_.clear();
+  checkpoints_.clear();
+  checkpointIndents_.clear();
+  pulled_ = 0;
+  lexedAll_ = false;
+}
+
+/**
+ * @brief Returns a lexem ahead of the stream without consuming it
+ *
+ * Lexes further top-level statements until the lexem is available; the
+ * lexems already returned by Next() are dropped then. Past the end of the
+ * source the EOC lexem is returned.
+ *
+ * @param ahead Number of lexems to look past the next one
+ * @return const Lexem& The lexem, valid until the next call of Peek(),
+ * Next() or one of the Analyze methods
+ * @throws std::runtime_error On the lexical errors of Analyze(), when the
+ * statement containing them is reached
+ */
+const Lexem& LexemAnalyzer::Peek(size_t ahead) {
+  while (pulled_ + ahead >= lexems_.size() && !lexedAll_) {
+    lexems_.erase(lexems_.begin(), lexems_.begin() + pulled_);
+    pulled_ = 0;
+    LexStatement();
+  }
+  return lexems_[std::min(pulled_ + ahead, lexems_.size() - 1)];
+}
+
+/**
+ * @brief Consumes the next lexem of the stream
+ *
+ * @return Lexem The lexem; the EOC lexem is returned again on every call
+ * once the end was reached
+ * @throws std::runtime_error On the lexical errors of Analyze(), when the
+ * statement containing them is reached
+ */
+Lexem LexemAnalyzer::Next() {
+  Lexem lexem = Peek();
+  if (pulled_ + 1 < lexems_.size() || !lexedAll_) {
+    ++pulled_;
+  }
+  return lexem;
+}
+
+/**
+ * @brief Lexes one more top-level statement for Peek(), the same as one
+ * iteration of AnalyzeProgram(); adds the EOC lexem at the end of the source
+ */
+void LexemAnalyzer::LexStatement() {
+  if (ch_ != '\0') {
+    SkipWhitespace();
+    if (ch_ != '\0') {
+      AnalyzeStatement();
+    }
+  }
+  if (ch_ == '\0') {
+    lexems_.emplace_back(
+        Lexem(LexemType::EOC, "eof", index_, index_ + 1, curLine_));
+    lexedAll_ = true;
+  }
+}
+
+/**
+ * @brief Records the current state as the start of a top-level statement
+ */
+void LexemAnalyzer::SaveCheckpoint() {
+  checkpoints_.push_back({Position(), lexems_.size(), curLine_,
+                          checkpointIndents_.size(), indentStack_.size()});
+  checkpointIndents_.insert(checkpointIndents_.end(), indentStack_.begin(),
+                            indentStack_.end());
+}
+
+/**
+ * @brief Checks whether the current state matches a checkpoint of another
+ * run, from which lexing would repeat that run
+ *
+ * @param resync The other run; the index of the matching checkpoint is
+ * stored in resync.match
+ * @return bool True if a checkpoint matched and lexing can stop
+ */
+bool LexemAnalyzer::Resynchronize(Resync& resync) {
+  size_t position = Position();
+  if (position < resync.end) {
+    return false;
+  }
+  size_t previous = position - resync.delta;
+  const LexemAnalyzer& run = *resync.run;
+  auto first = run.checkpoints_.begin() + resync.first;
+  auto last = run.checkpoints_.begin() + resync.checkpoints;
+  auto match = std::lower_bound(
+      first, last, previous,
+      [](const Checkpoint& c, size_t offset) { return c.offset < offset; });
+  if (match == last || match->offset != previous ||
+      match->indentDepth != indentStack_.size() ||
+      !std::equal(indentStack_.begin(), indentStack_.end(),
+                  run.checkpointIndents_.begin() + match->indentBegin)) {
+    return false;
+  }
+  resync.match = match - run.checkpoints_.begin();
+  return true;
+}
+
+/**
+ * @brief Points a lexem text taken from a previous source at the same
+ * characters in the current one
+ *
+ * @param text Lexem text; texts that are not views into from, such as
+ * "INDENT", are returned unchanged
+ * @param from The previous source
+ * @param delta Number of bytes the text moved by
+ */
+std::string_view LexemAnalyzer::Rebase(std::string_view text,
+                                       std::string_view from,
+                                       long delta) const {
+  std::less_equal<const char*> notAfter;
+  if (!notAfter(from.data(), text.data()) ||
+      !notAfter(text.data(), from.data() + from.size())) {
+    return text;
+  }
+  return std::string_view(code_.data() + (text.data() - from.data()) + delta,
+                          text.size());
 }
 
 /**
@@ -185,16 +743,26 @@ void LexemAnalyzer::Analyze() {
  * 3. Analyzing individual statements
  * 
  * The analysis continues until a null terminator ('\0') is encountered,
- * indicating the end of the input stream.
+ * indicating the end of the input stream, or a statement would start at
+ * stop_ or later.
+ * A checkpoint is saved before every statement.
+ *
+ * @param resync Another run to rejoin, checked before every statement
+ * @return bool True if lexing stopped at a checkpoint of that run
  */
-void LexemAnalyzer::AnalyzeProgram() {
-  while (ch_ != '\0') {
+bool LexemAnalyzer::AnalyzeProgram(Resync* resync) {
+  while (ch_ != '\0' && Position() < stop_) {
+    if (resync != nullptr && Resynchronize(*resync)) {
+      return true;
+    }
+    SaveCheckpoint();
     SkipWhitespace();
     if (ch_ == '\0') {
       break;
     }
     AnalyzeStatement();
   }
+  return false;
 }
 
 /**
@@ -221,15 +789,9 @@ void LexemAnalyzer::AnalyzeStatement() {
     return;
   }
   size_t startPos = currentPosition_;
-  std::string word;
   if (isalpha(ch_)) {
-    while (isalnum(ch_) || ch_ == '_') {
-      word += ch_;
-      GetNextChar();
-    }
-    auto [isKeyword, lexem] =
-        keywords_.has(word.c_str(), word.length(), startPos);
-    if (isKeyword) {
+    std::string_view word = ScanWord();
+    if (IsKeyword(word)) {
       lexems_.emplace_back(Lexem(LexemType::KEYWORD, word, startPos,
                                  currentPosition_, curLine_));
       if (word == "int" || word == "float" || word == "bool" ||
@@ -315,7 +877,8 @@ void LexemAnalyzer::AnalyzeAssignment() {
  */
 void LexemAnalyzer::PrintLexems() const {
   for (const auto& lexem : lexems_) {
-    std::cout << "TYPE: " << lexem.get_type() << " VALUE: " << lexem.get_text()
+    std::cout << "TYPE: " << lexem.get_type_name()
+              << " VALUE: " << lexem.get_text()
               << " On line: " << lexem.get_line() << std::endl;
   }
 }
@@ -369,19 +932,13 @@ void LexemAnalyzer::AnalyzeVariableDeclaration() {
  */
 void LexemAnalyzer::AnalyzeIdentifier() {
   size_t startPos = currentPosition_;
-  std::string word;
-  while (isalnum(ch_) || ch_ == '_') {
-    word += ch_;
-    GetNextChar();
-  }
+  std::string_view word = ScanWord();
   if (word.empty()) {
     GetNextChar();
     SkipWhitespace();
     return;
   }
-  auto [isKeyword, lexem] =
-      keywords_.has(word.c_str(), word.length(), startPos);
-  if (isKeyword) {
+  if (IsKeyword(word)) {
     lexems_.emplace_back(
         Lexem(LexemType::KEYWORD, word, startPos, currentPosition_, curLine_));
   } else {
@@ -425,35 +982,50 @@ void LexemAnalyzer::AnalyzeExpression() {
       AnalyzeString();
     } else if (ch_ == '(' || ch_ == ')' || ch_ == '{' || ch_ == '}' ||
                ch_ == '[' || ch_ == ']') {
-      lexems_.emplace_back(Lexem(LexemType::BRACKET, std::string(1, ch_),
+      lexems_.emplace_back(Lexem(LexemType::BRACKET,
+                                 code_.substr(index_ - 1, 1),
                                  currentPosition_, currentPosition_ + 1,
                                  curLine_));
       GetNextChar();
     } else if (ispunct(ch_)) {
-      lexems_.emplace_back(Lexem(LexemType::OPERATOR, std::string(1, ch_),
-                                 currentPosition_, currentPosition_ + 1,
-                                 curLine_));
-      GetNextChar();
+      AnalyzeOperator();
     } else {
       GetNextChar();
     }
   }
 }
 
-void LexemAnalyzer::AnalyzeNumber() {
-  std::string number;
-  while (isdigit(ch_)) {
-    number += ch_;
+/**
+ * @brief Emits the operator at the current character: a REL_OP for
+ * ==, !=, <=, >=, < and >, an OPERATOR for && and || and for any other
+ * punctuation character, which stands alone.
+ */
+void LexemAnalyzer::AnalyzeOperator() {
+  char next = index_ < code_.length() ? code_[index_] : '\0';
+  size_t length = 1;
+  if ((next == '=' && (ch_ == '=' || ch_ == '!' || ch_ == '<' ||
+                       ch_ == '>')) ||
+      (next == ch_ && (ch_ == '&' || ch_ == '|'))) {
+    length = 2;
+  }
+  bool relational = ch_ == '<' || ch_ == '>' || (length == 2 && next == '=');
+  lexems_.emplace_back(
+      Lexem(relational ? LexemType::REL_OP : LexemType::OPERATOR,
+            code_.substr(index_ - 1, length), currentPosition_,
+            currentPosition_ + length, curLine_));
+  for (size_t i = 0; i < length; ++i) {
     GetNextChar();
   }
+}
+
+void LexemAnalyzer::AnalyzeNumber() {
+  size_t begin = Position();
+  SkipTo(scan_.digits(code_.data(), begin, code_.size()));
   if (ch_ == '.') {
-    number += ch_;
     GetNextChar();
-    while (isdigit(ch_)) {
-      number += ch_;
-      GetNextChar();
-    }
+    SkipTo(scan_.digits(code_.data(), Position(), code_.size()));
   }
+  std::string_view number = code_.substr(begin, Position() - begin);
   lexems_.emplace_back(Lexem(LexemType::NUMBER, number,
                              currentPosition_ - number.length(),
                              currentPosition_, curLine_));
@@ -462,11 +1034,9 @@ void LexemAnalyzer::AnalyzeNumber() {
 
 void LexemAnalyzer::AnalyzeString() {
   GetNextChar();
-  std::string str;
-  while (ch_ != '"') {
-    str += ch_;
-    GetNextChar();
-  }
+  size_t begin = Position();
+  SkipTo(scan_.quote(code_.data(), begin, code_.size()));
+  std::string_view str = code_.substr(begin, Position() - begin);
   lexems_.emplace_back(Lexem(LexemType::STRING, str,
                              currentPosition_ - str.length(), currentPosition_,
                              curLine_));
@@ -637,21 +1207,13 @@ void LexemAnalyzer::AnalyzeForStatement() {
   AnalyzeIdentifier();
   SkipWhitespace();
   size_t startPos = currentPosition_;
-  std::string word;
-  while (isalnum(ch_) || ch_ == '_') {
-    word += ch_;
-    GetNextChar();
-  }
+  std::string_view word = ScanWord();
   if (word == "in") {
     lexems_.emplace_back(
         Lexem(LexemType::KEYWORD, "in", startPos, currentPosition_, curLine_));
     SkipWhitespace();
   }
-  word.clear();
-  while ((isalnum(ch_) || ch_ == '_') && ch_ != '(') {
-    word += ch_;
-    GetNextChar();
-  }
+  word = ScanWord();
   if (word == "range") {
     lexems_.emplace_back(Lexem(LexemType::KEYWORD, "range", startPos,
                                currentPosition_, curLine_));
@@ -0,0 +1,301 @@
+#include "Optimizer.h"
+#include <cctype>
+#include <cmath>
+#include <iomanip>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+#include "Value.h"
+
+namespace {
+
+/**
+ * @brief Formats a folded value as an operand that Value::FromLiteral()
+ * reads back unchanged, or returns nothing if there is no such spelling
+ * (negative numbers, exponents, infinities).
+ */
+std::optional<std::string> LiteralText(const Value& value) {
+  if (value.IsString()) {
+    return "\"" + value.AsString() + "\"";
+  }
+  if (value.IsInt()) {
+    if (value.AsInt() < 0) {
+      return std::nullopt;
+    }
+    return std::to_string(value.AsInt());
+  }
+  double number = value.AsFloat();
+  if (!std::isfinite(number) || number < 0) {
+    return std::nullopt;
+  }
+  std::ostringstream out;
+  out << std::setprecision(17) << number;
+  std::string text = out.str();
+  if (text.find('e') != std::string::npos) {
+    return std::nullopt;
+  }
+  if (text.find('.') == std::string::npos) {
+    text += ".0";
+  }
+  return text;
+}
+
+}  // namespace
+
+/**
+ * @brief Constructs an optimizer for the given RPN program.
+ *
+ * @param rpn Cells produced by RPN::getRPN()
+ */
+Optimizer::Optimizer(const std::vector<RPNCell>& rpn) : rpn_(rpn) {}
+
+/**
+ * @brief Runs the passes of an optimization level.
+ *
+ * @param level 0 to keep the cells as they are, 1 to optimize
+ * @return std::vector<RPNCell> The optimized cells
+ */
+std::vector<RPNCell> Optimizer::Run(int level) {
+  stats_ = OptimizerStats();
+  stats_.cellsBefore = rpn_.size();
+  if (level > 0) {
+    bool changed = true;
+    while (changed) {
+      changed = FoldConstants();
+      changed = ThreadJumps() || changed;
+      changed = EliminateDeadCode() || changed;
+    }
+  }
+  stats_.cellsAfter = rpn_.size();
+  return rpn_;
+}
+
+/**
+ * @brief Evaluates the operator cells whose operands are all literals.
+ *
+ * The operands of an operator are the values left by the cells before it,
+ * so it can be folded when that many Const cells directly precede it. The
+ * result replaces the operator and may in turn be an operand of the next
+ * one, so a whole literal subexpression folds in one pass.
+ *
+ * @return true if an expression changed
+ */
+bool Optimizer::FoldConstants() {
+  std::vector<bool> removed(rpn_.size(), false);
+  std::vector<size_t> constants;
+  bool anyRemoved = false;
+  for (size_t i = 0; i < rpn_.size(); ++i) {
+    RPNCell& cell = rpn_[i];
+    if (cell.type == CellType::ConstCell) {
+      constants.push_back(i);
+      continue;
+    }
+    std::optional<std::string> folded;
+    if (cell.type == CellType::MathCell && cell.op != Operator::Index &&
+        cell.op != Operator::Call && cell.op != Operator::Unknown &&
+        constants.size() >= cell.arity) {
+      try {
+        size_t first = constants.size() - cell.arity;
+        Value lhs = Value::FromLiteral(rpn_[constants[first]].value);
+        Value result = cell.arity == 1
+                           ? Value::Apply(cell.op, lhs)
+                           : Value::Apply(cell.op, lhs,
+                                          Value::FromLiteral(
+                                              rpn_[constants.back()].value));
+        folded = LiteralText(result);
+      } catch (const std::exception&) {
+      }
+    }
+    if (!folded) {
+      constants.clear();
+      continue;
+    }
+    for (uint32_t operand = 0; operand < cell.arity; ++operand) {
+      removed[constants.back()] = true;
+      constants.pop_back();
+    }
+    cell = RPNCell(CellType::ConstCell, *folded);
+    constants.push_back(i);
+    ++stats_.foldedOperators;
+    anyRemoved = true;
+  }
+  if (anyRemoved) {
+    RemoveCells(removed);
+  }
+  return anyRemoved;
+}
+
+/**
+ * @brief Shortens jump chains and drops GoTos to the label that follows
+ * them.
+ *
+ * @return true if a jump changed
+ */
+bool Optimizer::ThreadJumps() {
+  bool changed = false;
+  for (size_t i = 0; i < rpn_.size(); ++i) {
+    if (!IsJump(i) || (!IsUnconditionalJump(i) &&
+                       rpn_[i].type != CellType::ConditionalJumpCell)) {
+      continue;
+    }
+    size_t target = Target(i);
+    for (size_t steps = 0; steps < rpn_.size(); ++steps) {
+      size_t next = target;
+      while (next < rpn_.size() && rpn_[next].type == CellType::LabelCell &&
+             !IsFunctionLabel(next)) {
+        ++next;
+      }
+      if (next >= rpn_.size() || !IsUnconditionalJump(next) ||
+          Target(next) == target) {
+        break;
+      }
+      target = Target(next);
+    }
+    if (target != Target(i)) {
+      rpn_[i].value = std::to_string(target);
+      ++stats_.threadedJumps;
+      changed = true;
+    }
+  }
+
+  std::vector<bool> removed(rpn_.size(), false);
+  bool anyRemoved = false;
+  for (size_t i = 0; i < rpn_.size(); ++i) {
+    if (!IsUnconditionalJump(i)) {
+      continue;
+    }
+    size_t next = i + 1;
+    while (next < Target(i) && rpn_[next].type == CellType::LabelCell &&
+           !IsFunctionLabel(next)) {
+      ++next;
+    }
+    if (next == Target(i)) {
+      removed[i] = true;
+      anyRemoved = true;
+    }
+  }
+  if (anyRemoved) {
+    RemoveCells(removed);
+  }
+  return changed || anyRemoved;
+}
+
+/**
+ * @brief Removes unreachable cells and labels nothing jumps to.
+ *
+ * Code becomes reachable again at a referenced label, at the labels
+ * delimiting a function body and at a function definition.
+ *
+ * @return true if a cell was removed
+ */
+bool Optimizer::EliminateDeadCode() {
+  std::set<size_t> referenced = ReferencedCells();
+  std::vector<bool> removed(rpn_.size(), false);
+  bool anyRemoved = false;
+  bool dead = false;
+  for (size_t i = 0; i < rpn_.size(); ++i) {
+    const RPNCell& cell = rpn_[i];
+    if (cell.type == CellType::LabelCell) {
+      if (IsFunctionLabel(i) || referenced.count(i)) {
+        dead = false;
+      } else {
+        removed[i] = anyRemoved = true;
+      }
+      continue;
+    }
+    if (cell.type == CellType::FunctionCell && cell.value != "print") {
+      dead = false;
+    }
+    if (dead) {
+      removed[i] = anyRemoved = true;
+      continue;
+    }
+    if (cell.type == CellType::ReturnCell || IsUnconditionalJump(i)) {
+      dead = true;
+    }
+  }
+  if (anyRemoved) {
+    RemoveCells(removed);
+  }
+  return anyRemoved;
+}
+
+/**
+ * @brief Drops the marked cells and remaps the targets of the remaining
+ * jumps.
+ *
+ * Jumps only target labels and function definitions, which are never
+ * marked while referenced.
+ */
+void Optimizer::RemoveCells(const std::vector<bool>& removed) {
+  std::vector<size_t> newIndex(rpn_.size() + 1);
+  size_t kept = 0;
+  for (size_t i = 0; i < rpn_.size(); ++i) {
+    newIndex[i] = kept;
+    kept += removed[i] ? 0 : 1;
+  }
+  newIndex[rpn_.size()] = kept;
+
+  std::vector<RPNCell> cells;
+  cells.reserve(kept);
+  for (size_t i = 0; i < rpn_.size(); ++i) {
+    if (removed[i]) {
+      continue;
+    }
+    cells.push_back(rpn_[i]);
+    if (IsJump(i)) {
+      cells.back().value = std::to_string(newIndex[Target(i)]);
+    }
+  }
+  rpn_ = std::move(cells);
+}
+
+/**
+ * @brief Returns the cells jumps and calls refer to.
+ */
+std::set<size_t> Optimizer::ReferencedCells() const {
+  std::set<size_t> referenced;
+  for (size_t i = 0; i < rpn_.size(); ++i) {
+    if (IsJump(i)) {
+      referenced.insert(Target(i));
+    }
+  }
+  return referenced;
+}
+
+bool Optimizer::IsJump(size_t index) const {
+  return rpn_[index].type == CellType::GoToCell ||
+         rpn_[index].type == CellType::ConditionalJumpCell;
+}
+
+/**
+ * @brief Checks for a GoToCell that is not the second half of a call.
+ */
+bool Optimizer::IsUnconditionalJump(size_t index) const {
+  return rpn_[index].type == CellType::GoToCell &&
+         !(index > 0 && rpn_[index - 1].type == CellType::CallCeil);
+}
+
+/**
+ * @brief Checks for the begin_func and end_func labels, which delimit a
+ * function body and must stay even when nothing jumps to them.
+ */
+bool Optimizer::IsFunctionLabel(size_t index) const {
+  const std::string& label = rpn_[index].value;
+  return rpn_[index].type == CellType::LabelCell &&
+         (label.rfind("begin_func_", 0) == 0 ||
+          label.rfind("end_func_", 0) == 0);
+}
+
+/**
+ * @brief Returns the target cell of a jump.
+ *
+ * @throws std::runtime_error if the jump was left unresolved
+ */
+size_t Optimizer::Target(size_t index) const {
+  const std::string& target = rpn_[index].value;
+  if (target.empty() || !isdigit(target[0])) {
+    throw std::runtime_error("Unresolved jump target: " + target);
+  }
+  return std::stoul(target);
+}
@@ -0,0 +1,332 @@
+#include "ProgramImage.h"
+#include <cctype>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <stdexcept>
+
+namespace {
+
+const char kMagic[8] = {'S', 'I', 'G', 'M', 'A', 'U', 'S', 'C'};
+const uint32_t kByteOrderMark = 0x01020304;
+
+struct Section {
+  uint32_t offset;
+  uint32_t count;
+};
+
+struct Header {
+  char magic[8];
+  uint32_t version;
+  uint32_t byteOrder;
+  Section cells;
+  Section constants;
+  Section symbols;
+  Section labels;
+  Section strings;
+};
+
+struct StringRef {
+  uint32_t offset;
+  uint32_t size;
+};
+
+struct ImageCell {
+  uint8_t type;
+  uint8_t op;
+  uint8_t named;
+  uint8_t reserved;
+  uint32_t arity;
+  uint32_t operand;
+};
+
+struct ImageLabel {
+  StringRef name;
+  uint32_t cell;
+};
+
+static_assert(sizeof(Header) == 56, "Header layout is part of the format");
+static_assert(sizeof(ImageCell) == 12, "Cell layout is part of the format");
+static_assert(sizeof(ImageLabel) == 12, "Label layout is part of the format");
+
+bool IsJump(CellType type) {
+  return type == CellType::GoToCell || type == CellType::ConditionalJumpCell;
+}
+
+bool IsNumber(const std::string& text) {
+  if (text.empty()) {
+    return false;
+  }
+  for (char c : text) {
+    if (!isdigit(static_cast<unsigned char>(c))) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * @brief Lays out the tables of an image as its cells are added
+ */
+class ImageBuilder {
+ public:
+  void Add(const RPNCell& cell) {
+    ImageCell record{static_cast<uint8_t>(cell.type),
+                     static_cast<uint8_t>(cell.op),
+                     cell.symbol != kNoSymbol, 0, cell.arity, 0};
+    if (cell.type == CellType::ConstCell) {
+      record.operand = Intern(cell.value, constantIndex_, constants_);
+    } else if (cell.type == CellType::LabelCell) {
+      record.operand = labels_.size();
+      labels_.push_back({String(cell.value), Count(cells_.size())});
+    } else if (IsJump(cell.type)) {
+      if (!IsNumber(cell.value)) {
+        throw std::runtime_error("Unresolved jump target: " + cell.value);
+      }
+      record.operand = Count(std::stoull(cell.value));
+    } else {
+      record.operand = Intern(cell.value, symbolIndex_, symbols_);
+    }
+    cells_.push_back(record);
+  }
+
+  std::string Build() const {
+    Header header;
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = ProgramImage::kVersion;
+    header.byteOrder = kByteOrderMark;
+    uint64_t offset = sizeof(Header);
+    header.cells = Place(offset, cells_.size(), sizeof(ImageCell));
+    header.constants = Place(offset, constants_.size(), sizeof(StringRef));
+    header.symbols = Place(offset, symbols_.size(), sizeof(StringRef));
+    header.labels = Place(offset, labels_.size(), sizeof(ImageLabel));
+    header.strings = Place(offset, strings_.size(), 1);
+
+    std::string image(offset, '\0');
+    Copy(image, 0, &header, 1);
+    Copy(image, header.cells.offset, cells_.data(), cells_.size());
+    Copy(image, header.constants.offset, constants_.data(),
+         constants_.size());
+    Copy(image, header.symbols.offset, symbols_.data(), symbols_.size());
+    Copy(image, header.labels.offset, labels_.data(), labels_.size());
+    Copy(image, header.strings.offset, strings_.data(), strings_.size());
+    return image;
+  }
+
+ private:
+  std::vector<ImageCell> cells_;
+  std::vector<StringRef> constants_;
+  std::vector<StringRef> symbols_;
+  std::vector<ImageLabel> labels_;
+  std::string strings_;
+  std::map<std::string, uint32_t> constantIndex_;
+  std::map<std::string, uint32_t> symbolIndex_;
+
+  static uint32_t Count(uint64_t count) {
+    if (count > UINT32_MAX) {
+      throw std::runtime_error("Program too large for a program image");
+    }
+    return static_cast<uint32_t>(count);
+  }
+
+  StringRef String(const std::string& text) {
+    StringRef ref{Count(strings_.size()), Count(text.size())};
+    strings_ += text;
+    return ref;
+  }
+
+  uint32_t Intern(const std::string& text,
+                  std::map<std::string, uint32_t>& index,
+                  std::vector<StringRef>& table) {
+    auto [it, added] = index.emplace(text, table.size());
+    if (added) {
+      table.push_back(String(text));
+    }
+    return it->second;
+  }
+
+  static Section Place(uint64_t& offset, size_t count, size_t size) {
+    Section section{Count(offset), Count(count)};
+    offset += count * size;
+    // Keep every record 4-byte aligned.
+    offset = (offset + 3) & ~uint64_t(3);
+    Count(offset);
+    return section;
+  }
+
+  template <typename T>
+  static void Copy(std::string& image, uint32_t offset, const T* data,
+                   size_t count) {
+    if (count > 0) {
+      std::memcpy(&image[offset], data, count * sizeof(T));
+    }
+  }
+};
+
+/**
+ * @brief Bounds-checked reads of the records of a mapped image
+ */
+class ImageReader {
+ public:
+  ImageReader(std::string_view image, const std::string& path)
+      : image_(image), path_(path) {}
+
+  std::runtime_error Invalid(const std::string& what) const {
+    return std::runtime_error("Invalid program image '" + path_ +
+                              "': " + what);
+  }
+
+  template <typename T>
+  T Read(uint64_t offset) const {
+    if (offset + sizeof(T) > image_.size()) {
+      throw Invalid("truncated");
+    }
+    T value;
+    std::memcpy(&value, image_.data() + offset, sizeof(T));
+    return value;
+  }
+
+  template <typename T>
+  T Record(const Section& section, uint32_t index) const {
+    if (index >= section.count) {
+      throw Invalid("index out of range");
+    }
+    return Read<T>(section.offset + uint64_t(index) * sizeof(T));
+  }
+
+  void CheckSection(const Section& section, size_t size) const {
+    if (section.offset + uint64_t(section.count) * size > image_.size()) {
+      throw Invalid("section out of range");
+    }
+  }
+
+  std::string Text(const Section& strings, const StringRef& ref) const {
+    if (uint64_t(ref.offset) + ref.size > strings.count) {
+      throw Invalid("string out of range");
+    }
+    return std::string(image_.substr(strings.offset + ref.offset, ref.size));
+  }
+
+ private:
+  std::string_view image_;
+  const std::string& path_;
+};
+
+}  // namespace
+
+/**
+ * @brief Writes the image of a program.
+ *
+ * @param cells Cells as RunProgram() executes them, i.e. optimized
+ * @param path File to write, replaced if it exists
+ * @throws std::runtime_error if a jump is unresolved or the file cannot be
+ *         written
+ */
+void ProgramImage::Write(const std::vector<RPNCell>& cells,
+                         const std::string& path) {
+  ImageBuilder builder;
+  for (const RPNCell& cell : cells) {
+    builder.Add(cell);
+  }
+  std::string image = builder.Build();
+  std::ofstream file(path, std::ios::binary | std::ios::trunc);
+  if (!file.write(image.data(), image.size())) {
+    throw std::runtime_error("Failed to write '" + path + "'");
+  }
+}
+
+/**
+ * @brief Maps the image at the given path and checks its header.
+ *
+ * @throws std::runtime_error if the file cannot be read, is not a program
+ *         image of this version and byte order, or a section lies outside
+ *         of it
+ */
+ProgramImage::ProgramImage(const std::string& path)
+    : path_(path), file_(path) {
+  ImageReader reader(file_.View(), path_);
+  if (file_.View().size() < sizeof(Header) ||
+      file_.View().compare(0, sizeof(kMagic),
+                           std::string_view(kMagic, sizeof(kMagic))) != 0) {
+    throw reader.Invalid("not a program image");
+  }
+  Header header = reader.Read<Header>(0);
+  if (header.byteOrder != kByteOrderMark) {
+    throw reader.Invalid("written on a machine of another byte order");
+  }
+  if (header.version != kVersion) {
+    throw reader.Invalid("format version " + std::to_string(header.version) +
+                         ", expected " + std::to_string(kVersion));
+  }
+  reader.CheckSection(header.cells, sizeof(ImageCell));
+  reader.CheckSection(header.constants, sizeof(StringRef));
+  reader.CheckSection(header.symbols, sizeof(StringRef));
+  reader.CheckSection(header.labels, sizeof(ImageLabel));
+  reader.CheckSection(header.strings, 1);
+}
+
+/**
+ * @brief Rebuilds the cells of the program for BytecodeCompiler.
+ *
+ * Names are interned once per symbol table entry, whatever the number of
+ * cells referring to them.
+ *
+ * @throws std::runtime_error if a record is malformed
+ */
+std::vector<RPNCell> ProgramImage::Cells() const {
+  ImageReader reader(file_.View(), path_);
+  Header header = reader.Read<Header>(0);
+  std::vector<std::string> symbols(header.symbols.count);
+  std::vector<SymbolId> ids(header.symbols.count, kNoSymbol);
+  for (uint32_t i = 0; i < header.symbols.count; ++i) {
+    symbols[i] = reader.Text(header.strings,
+                             reader.Record<StringRef>(header.symbols, i));
+  }
+
+  std::vector<RPNCell> cells;
+  cells.reserve(header.cells.count);
+  for (uint32_t i = 0; i < header.cells.count; ++i) {
+    ImageCell record = reader.Record<ImageCell>(header.cells, i);
+    if (record.type > static_cast<uint8_t>(CellType::LoadCell) ||
+        record.op > static_cast<uint8_t>(Operator::Unknown)) {
+      throw reader.Invalid("unknown cell at " + std::to_string(i));
+    }
+    CellType type = static_cast<CellType>(record.type);
+    std::string value;
+    SymbolId symbol = kNoSymbol;
+    if (type == CellType::ConstCell) {
+      StringRef literal =
+          reader.Record<StringRef>(header.constants, record.operand);
+      value = reader.Text(header.strings, literal);
+    } else if (type == CellType::LabelCell) {
+      ImageLabel label =
+          reader.Record<ImageLabel>(header.labels, record.operand);
+      if (label.cell != i) {
+        throw reader.Invalid("label table does not match cell " +
+                             std::to_string(i));
+      }
+      value = reader.Text(header.strings, label.name);
+    } else if (IsJump(type)) {
+      if (record.operand >= header.cells.count) {
+        throw reader.Invalid("jump out of range at " + std::to_string(i));
+      }
+      value = std::to_string(record.operand);
+    } else {
+      if (record.operand >= header.symbols.count) {
+        throw reader.Invalid("index out of range");
+      }
+      value = symbols[record.operand];
+      if (record.named) {
+        SymbolId& id = ids[record.operand];
+        if (id == kNoSymbol) {
+          id = InternSymbol(value);
+        }
+        symbol = id;
+      }
+    }
+    cells.emplace_back(type, std::move(value), symbol);
+    cells.back().op = static_cast<Operator>(record.op);
+    cells.back().arity = record.arity;
+  }
+  return cells;
+}
@@ -1,351 +1,495 @@
 #include "RPN.h"
 #include <iostream>
 #include <stdexcept>
-
-RPN::RPN(const std::vector<Lexem>& lexems)
-    : lexems_(lexems), curLex_(lexems[0]), index_(0) {}
-
+#include <utility>
+
+/**
+ * @brief Prepares the generation of the cells of a program.
+ *
+ * @param ast Tree built by SyntaxAnalyzer; it is not copied and must
+ *        outlive the generator.
+ */
+RPN::RPN(const Ast& ast) : ast_(ast) {}
+
+/**
+ * @brief Walks the tree of the program and emits its cells, then resolves
+ * the jumps.
+ *
+ * @throws std::runtime_error on constructs the cells cannot express and on
+ *         undefined labels or functions
+ */
 void RPN::buildRPN() {
   rpn_.clear();
-  labels.clear();
-  while (curLex_.get_type() != "EOC") {
-    AnalyzeLexemsList();
-  }
+  labelNames_.clear();
+  labelCells_.clear();
+  functionCells_.clear();
+  relocations_.clear();
+  funcEndLabel_ = kNoCell;
+  buildBlockRPN(ast_.program);
+  resolveLabels();
 }
 
-void RPN::AnalyzeLexemsList() {
-  if (curLex_.get_type() == "DEDENT") {
-    getLexem();
-  }
-  if (curLex_.get_type() == "EOC") {
-    return;
-  }
-  if (curLex_.get_type() == "INDENT") {
-    getLexem();
-  }
-  if (curLex_.get_type() == "KEYWORD") {
-    if (curLex_.get_text() == "def") {
-      buildFunctionRPN();
-    } else if (curLex_.get_text() == "if") {
-      buildIfRPN();
-    } else if (curLex_.get_text() == "while") {
-      buildWhileRPN();
-    } else if (curLex_.get_text() == "for") {
-      buildForRPN();
-    } else if (curLex_.get_text() == "print") {
-      buildPrintRPN();
-    } else if (curLex_.get_text() == "return") {
-      buildReturnCellRPN();
-    } else if (curLex_.get_text() == "int" || curLex_.get_text() == "float" ||
-               curLex_.get_text() == "string") {
-      buildAssignmentRPN();
-    } else if (isOperator(curLex_.get_text()) || isRelOp(curLex_.get_text())) {
-      buildMathOperationRPN();
-    } else {
-      throw std::runtime_error("Unexpected keyword: " + curLex_.get_text());
-    }
-  } else if (curLex_.get_type() == "IDENTIFIER") {
-    auto name = curLex_.get_text();
-    getLexem();
-    if (curLex_.get_text() == "=") {
-      buildRPNCell(RPNCell(CellType::VarCell, name));
-      getLexem();
-      buildMathOperationRPN();
-      buildRPNCell(RPNCell(CellType::MathCell, "="));
-    } else if (curLex_.get_text() == "(") {
-      buildRPNCell(RPNCell(CellType::CallCeil, name));
-      buildRPNCell(RPNCell(CellType::GoToCell, std::to_string(labels[name])));
-      getLexem();
-      getLexem();
+/**
+ * @brief Back-patches every jump recorded in the relocation table with the
+ * absolute index of its target cell.
+ *
+ * Labels are numbered and functions are interned, so both targets are
+ * looked up by index. Calls are relocated against the FunctionCell of the
+ * callee, so functions defined after the call site link correctly.
+ *
+ * @throws std::runtime_error if a label or function was never defined
+ */
+void RPN::resolveLabels() {
+  for (const Relocation& relocation : relocations_) {
+    const std::vector<size_t>& cells =
+        relocation.call ? functionCells_ : labelCells_;
+    size_t target = relocation.target < cells.size()
+                        ? cells[relocation.target]
+                        : kNoCell;
+    if (target == kNoCell) {
+      if (relocation.call) {
+        throw std::runtime_error("Undefined function: " +
+                                 std::string(SymbolName(relocation.target)));
+      }
+      throw std::runtime_error("Undefined label: " +
+                               labelNames_[relocation.target]);
     }
+    rpn_[relocation.cell].value = std::to_string(target);
   }
-  if (curLex_.get_type() == "NEWLINE") {
-    getLexem();
+  relocations_.clear();
+}
+
+void RPN::buildBlockRPN(const Block& block) {
+  for (const Statement* statement : block) {
+    buildStatementRPN(*statement);
   }
 }
 
-void RPN::printRPN() const {
+void RPN::buildStatementRPN(const Statement& statement) {
+  switch (statement.kind) {
+    case NodeKind::Function:
+      buildFunctionRPN(static_cast<const FunctionNode&>(statement));
+      break;
+    case NodeKind::Declaration:
+      buildDeclarationRPN(static_cast<const DeclarationNode&>(statement));
+      break;
+    case NodeKind::Assignment:
+      buildAssignmentRPN(static_cast<const AssignmentNode&>(statement));
+      break;
+    case NodeKind::Call:
+      buildCallRPN(static_cast<const CallNode&>(statement));
+      break;
+    case NodeKind::If:
+      buildIfRPN(static_cast<const IfNode&>(statement));
+      break;
+    case NodeKind::While:
+      buildWhileRPN(static_cast<const WhileNode&>(statement));
+      break;
+    case NodeKind::For:
+      buildForRPN(static_cast<const ForNode&>(statement));
+      break;
+    case NodeKind::Print:
+      buildPrintRPN(static_cast<const PrintNode&>(statement));
+      break;
+    case NodeKind::Return:
+      buildReturnCellRPN(static_cast<const ReturnNode&>(statement));
+      break;
+    case NodeKind::Jump:
+      throw std::runtime_error(
+          "Unexpected keyword: " +
+          std::string(static_cast<const JumpNode&>(statement).text));
+  }
+}
+
+void RPN::printRPN() const { printCells(rpn_); }
+
+/**
+ * @brief Prints a listing of cells, one "[index] [Type: .., Value: ..]"
+ * line per cell, as printRPN() does for the program being built.
+ */
+void RPN::printCells(const std::vector<RPNCell>& cells) {
   size_t index = 0;
-  for (const auto& cell : rpn_) {
+  for (const auto& cell : cells) {
     std::cout << "[" << index++ << "] [Type: " << cell.GetTypeAsString()
               << ", Value: " << cell.value << "]" << std::endl;
   }
 }
 
-void RPN::buildMathOperationRPN(std::string start) {
-  std::string expression = start + curLex_.get_text();
-  while (curLex_.get_type() != "NEWLINE") {
-    getLexem();
-    if (curLex_.get_text() == ";" || curLex_.get_text() == ":") {
+namespace {
+
+/**
+ * @brief Returns the binary operator a lexem stands for and its precedence,
+ * from 1 for || to 6 for * / %; precedence 0 when the lexem is not one.
+ */
+std::pair<Operator, int> BinaryOperator(const Lexem& token) {
+  switch (token.get_keyword()) {
+    case Keyword::Or:
+      return {Operator::Or, 1};
+    case Keyword::And:
+      return {Operator::And, 2};
+    default:
       break;
-    }
-    expression += curLex_.get_text();
-  }
-  if (expression.empty()) {
-    throw std::runtime_error("Empty expression");
   }
-  if (expression[expression.size() - 1] == 'n' and
-      expression[expression.size() - 2] == '\\') {
-    expression.pop_back();
-    expression.pop_back();
+  switch (token.get_symbol()) {
+    case Symbol::Or:
+      return {Operator::Or, 1};
+    case Symbol::And:
+      return {Operator::And, 2};
+    case Symbol::Equal:
+      return {Operator::Equal, 3};
+    case Symbol::NotEqual:
+      return {Operator::NotEqual, 3};
+    case Symbol::Less:
+      return {Operator::Less, 4};
+    case Symbol::Greater:
+      return {Operator::Greater, 4};
+    case Symbol::LessEqual:
+      return {Operator::LessEqual, 4};
+    case Symbol::GreaterEqual:
+      return {Operator::GreaterEqual, 4};
+    case Symbol::Plus:
+      return {Operator::Add, 5};
+    case Symbol::Minus:
+      return {Operator::Sub, 5};
+    case Symbol::Star:
+      return {Operator::Mul, 6};
+    case Symbol::Slash:
+      return {Operator::Div, 6};
+    case Symbol::Percent:
+      return {Operator::Mod, 6};
+    default:
+      return {Operator::Unknown, 0};
   }
-  std::stack<std::string> operators;
-  std::string result;
-  std::string current;
-
-  for (char c : expression) {
-    if (isspace(c))
-      continue;
+}
 
-    if (isalnum(c) || c == '_' || c == '.') {
-      current += c;
-    } else {
-      if (!current.empty()) {
-        result += "[" + current + "]";
-        current.clear();
-      }
+std::runtime_error UnexpectedToken(const Lexem& token) {
+  return std::runtime_error("Unexpected token in expression: " +
+                            std::string(token.get_text()) + " on line " +
+                            std::to_string(token.get_line()));
+}
 
-      if (c == '(') {
-        operators.push("(");
-      } else if (c == ')') {
-        while (!operators.empty() && operators.top() != "(") {
-          result += operators.top();
-          operators.pop();
-        }
-        if (!operators.empty()) {
-          operators.pop();
-        }
-      } else {
-        std::string op(1, c);
-        while (!operators.empty() && operators.top() != "(" &&
-               getPrecedence(operators.top()) >= getPrecedence(op)) {
-          result += operators.top();
-          operators.pop();
-        }
-        operators.push(op);
-      }
-    }
+}  // namespace
+
+/**
+ * @brief Emits the cells of an expression in postfix order, one per
+ * operand or operator; an empty expression emits nothing.
+ *
+ * @throws std::runtime_error on a malformed expression
+ */
+void RPN::buildMathOperationRPN(const Expression& expression) {
+  const Span<Lexem>& tokens = expression.tokens;
+  if (tokens.empty()) {
+    return;
   }
-
-  if (!current.empty()) {
-    result += "[" + current + "]";
+  size_t end = buildExpressionRPN(tokens, 0, 1);
+  if (end != tokens.size) {
+    throw UnexpectedToken(tokens.data[end]);
   }
+}
 
-  while (!operators.empty()) {
-    if (operators.top() != "(") {
-      result += operators.top();
+/**
+ * @brief Compiles the longest expression starting at a token whose binary
+ * operators all bind at least as tightly as minPrecedence, by precedence
+ * climbing:
+ *
+ *   1 ||, or          4 < > <= >=       7 unary ! not -
+ *   2 &&, and         5 + -             8 call f(...), subscript a[i]
+ *   3 == !=           6 * / %
+ *
+ * Binary operators are left-associative, unary ones right-associative.
+ *
+ * @return size_t Index of the first token after the expression
+ */
+size_t RPN::buildExpressionRPN(const Span<Lexem>& tokens, size_t pos,
+                               int minPrecedence) {
+  pos = buildUnaryRPN(tokens, pos);
+  while (pos < tokens.size) {
+    const Lexem& token = tokens.data[pos];
+    auto [op, precedence] = BinaryOperator(token);
+    if (precedence < minPrecedence) {
+      break;
     }
-    operators.pop();
+    pos = buildExpressionRPN(tokens, pos + 1, precedence + 1);
+    buildRPNCell(RPNCell(op, std::string(token.get_text()), 2));
   }
-  buildRPNCell(RPNCell(CellType::MathCell, result));
-  getLexem();
+  return pos;
 }
 
-void RPN::buildFunctionRPN() {
-  while (curLex_.get_type() != "IDENTIFIER") {
-    getLexem();
+/**
+ * @brief Compiles a unary expression: prefix operators followed by an
+ * operand and its calls and subscripts.
+ *
+ * @return size_t Index of the first token after the expression
+ */
+size_t RPN::buildUnaryRPN(const Span<Lexem>& tokens, size_t pos) {
+  if (pos >= tokens.size) {
+    throw std::runtime_error("Unexpected end of expression on line " +
+                             std::to_string(tokens.data[pos - 1].get_line()));
   }
-  RPNCell funcCell(CellType::FunctionCell, curLex_.get_text());
-  labels[curLex_.get_text()] = rpn_.size();
-  buildRPNCell(funcCell);
-  getLexem();
-  getLexem();
-  getLexem();
-  getLexem();
-  while (curLex_.get_type() != "DEDENT" && curLex_.get_type() != "EOC") {
-    AnalyzeLexemsList();
+  const Lexem& token = tokens.data[pos];
+  if (token.get_symbol() == Symbol::Minus ||
+      token.get_symbol() == Symbol::Not ||
+      token.get_keyword() == Keyword::Not) {
+    pos = buildUnaryRPN(tokens, pos + 1);
+    bool negate = token.get_symbol() == Symbol::Minus;
+    buildRPNCell(RPNCell(negate ? Operator::Negate : Operator::Not,
+                         std::string(token.get_text()), 1));
+    return pos;
   }
-  buildRPNCell(RPNCell(CellType::LabelCell, "end_func"));
-}
-
-void RPN::buildAssignmentRPN() {
-  while (curLex_.get_type() != "IDENTIFIER") {
-    getLexem();
+  if (token.get_symbol() == Symbol::Plus) {
+    return buildUnaryRPN(tokens, pos + 1);
   }
-  buildRPNCell(RPNCell(CellType::VarCell, curLex_.get_text()));
-  getLexem();
-  if (curLex_.get_text() == "=") {
-    getLexem();
-    buildMathOperationRPN();
+  pos = buildOperandRPN(tokens, pos);
+  while (pos < tokens.size &&
+         tokens.data[pos].get_symbol() == Symbol::LeftBracket) {
+    pos = buildExpressionRPN(tokens, pos + 1, 1);
+    if (pos >= tokens.size ||
+        tokens.data[pos].get_symbol() != Symbol::RightBracket) {
+      throw std::runtime_error("Expected ']' on line " +
+                               std::to_string(token.get_line()));
+    }
+    buildRPNCell(RPNCell(Operator::Index, "[]", 2));
+    ++pos;
   }
-  buildRPNCell(RPNCell(CellType::MathCell, "="));
+  return pos;
 }
 
-void RPN::buildPrintRPN() {
-  getLexem();
-  buildMathOperationRPN();
-  buildRPNCell(RPNCell(CellType::FunctionCell, "print"));
-}
-
-void RPN::buildIfRPN() {
-  getLexem();
-  buildMathOperationRPN();
-  RPNCell ifCell(CellType::LabelCell, "if_false");
-  buildRPNCell(RPNCell(CellType::ConditionalJumpCell, "if_false"));
-  getLexem();
-  getLexem();
-  while (curLex_.get_type() != "DEDENT" && curLex_.get_type() != "EOC") {
-    AnalyzeLexemsList();
+/**
+ * @brief Compiles a literal, a variable, a call or a parenthesized
+ * expression.
+ *
+ * Literals become Const cells: numbers as written, strings quoted and
+ * true/false as 1/0. The arguments of a call are compiled left to right
+ * before the Call cell, whose arity is their number.
+ *
+ * @return size_t Index of the first token after the operand
+ */
+size_t RPN::buildOperandRPN(const Span<Lexem>& tokens, size_t pos) {
+  const Lexem& token = tokens.data[pos];
+  std::string text(token.get_text());
+  bool call = pos + 1 < tokens.size &&
+              tokens.data[pos + 1].get_symbol() == Symbol::LeftParen;
+  switch (token.get_type()) {
+    case LexemType::NUMBER:
+      buildRPNCell(RPNCell(CellType::ConstCell, text));
+      return pos + 1;
+    case LexemType::STRING:
+      buildRPNCell(RPNCell(CellType::ConstCell, "\"" + text + "\""));
+      return pos + 1;
+    case LexemType::IDENTIFIER:
+      if (!call) {
+        buildRPNCell(RPNCell(CellType::LoadCell, text, token.get_id()));
+        return pos + 1;
+      }
+      break;
+    case LexemType::KEYWORD:
+      if (token.get_keyword() == Keyword::True ||
+          token.get_keyword() == Keyword::False) {
+        bool value = token.get_keyword() == Keyword::True;
+        buildRPNCell(RPNCell(CellType::ConstCell, value ? "1" : "0"));
+        return pos + 1;
+      }
+      if (!call) {
+        throw UnexpectedToken(token);
+      }
+      break;
+    default:
+      if (token.get_symbol() != Symbol::LeftParen) {
+        throw UnexpectedToken(token);
+      }
+      pos = buildExpressionRPN(tokens, pos + 1, 1);
+      if (pos >= tokens.size ||
+          tokens.data[pos].get_symbol() != Symbol::RightParen) {
+        throw std::runtime_error("Expected ')' on line " +
+                                 std::to_string(token.get_line()));
+      }
+      return pos + 1;
   }
-  buildRPNCell(RPNCell(CellType::GoToCell, "if_end"));
-  getLexem();
-  getLexem();
-  buildRPNCell(ifCell);
-  labels["if_false"] = rpn_.size();
-  if (curLex_.get_text() == "else") {
-    getLexem();
-    getLexem();
-    while (curLex_.get_type() != "DEDENT" && curLex_.get_type() != "EOC") {
-      AnalyzeLexemsList();
+
+  uint32_t arguments = 0;
+  pos += 2;
+  while (pos < tokens.size &&
+         tokens.data[pos].get_symbol() != Symbol::RightParen) {
+    pos = buildExpressionRPN(tokens, pos, 1);
+    ++arguments;
+    if (pos < tokens.size && tokens.data[pos].get_symbol() == Symbol::Comma) {
+      ++pos;
+    } else if (pos < tokens.size &&
+               tokens.data[pos].get_symbol() != Symbol::RightParen) {
+      throw UnexpectedToken(tokens.data[pos]);
     }
   }
-  buildRPNCell(RPNCell(CellType::LabelCell, "if_end"));
-  labels["if_end"] = rpn_.size();
-}
-
-void RPN::buildWhileRPN() {
-  buildRPNCell(RPNCell(CellType::LabelCell, "while_start"));
-  labels["while_start"] = rpn_.size();
-  getLexem();
-  buildMathOperationRPN();
-  RPNCell jumpCell(CellType::ConditionalJumpCell, "while_false");
-  buildRPNCell(jumpCell);
-  size_t condIndex = rpn_.size() - 1;
-  while (curLex_.get_type() != "DEDENT" && curLex_.get_type() != "EOC") {
-    AnalyzeLexemsList();
+  if (pos >= tokens.size) {
+    throw std::runtime_error("Expected ')' on line " +
+                             std::to_string(token.get_line()));
   }
-  buildRPNCell(RPNCell(CellType::GoToCell, "while_start"));
-  labels["while_false"] = rpn_.size();
-  buildRPNCell(RPNCell(CellType::LabelCell, "while_false"));
+  buildRPNCell(RPNCell(Operator::Call, text, arguments, token.get_id()));
+  return pos + 1;
 }
 
-void RPN::buildForRPN() {
-  getLexem();
-  auto identifier = curLex_.get_text();
-  buildRPNCell(RPNCell(CellType::LabelCell, "start_for"));
-  labels["start_for"] = rpn_.size();
-  getLexem();
-  getLexem();
-  getLexem();
-  getLexem();
-  buildMathOperationRPN(identifier + "<");
-  buildRPNCell(RPNCell(CellType::ConditionalJumpCell, "end_for"));
-  while (curLex_.get_type() != "DEDENT" && curLex_.get_type() != "EOC") {
-    AnalyzeLexemsList();
+/**
+ * @brief Emits a definition: FunctionCell(name), one VarCell per
+ * parameter, LabelCell(begin_func_N), body, LabelCell(end_func_M).
+ */
+void RPN::buildFunctionRPN(const FunctionNode& node) {
+  if (functionCells_.size() <= node.name) {
+    functionCells_.resize(node.name + 1, kNoCell);
   }
-  buildRPNCell(RPNCell(CellType::GoToCell, "start_for"));
-  buildRPNCell(RPNCell(CellType::LabelCell, "end_for"));
-}
-
-void RPN::buildFunctionCallRPN() {
-  getLexem();
-  std::string funcName = curLex_.get_text();
-  buildRPNCell(RPNCell(CellType::FunctionCell, funcName));
-  getLexem();
-  getLexem();
-  while (curLex_.get_text() != ")" && curLex_.get_type() != "EOC") {
-    buildMathOperationRPN();
-    if (curLex_.get_text() == ",") {
-      getLexem();
-    }
+  functionCells_[node.name] = rpn_.size();
+  buildRPNCell(RPNCell(CellType::FunctionCell,
+                       std::string(SymbolName(node.name)), node.name));
+  size_t endLabel = newLabel("end_func");
+  funcEndLabel_ = endLabel;
+  for (const Parameter& parameter : node.parameters) {
+    buildRPNCell(RPNCell(CellType::VarCell,
+                         std::string(SymbolName(parameter.name)),
+                         parameter.name));
   }
-  buildRPNCell(RPNCell(CellType::GoToCell, funcName));
-  getLexem();
+  placeLabel(newLabel("begin_func"));
+  buildBlockRPN(node.body);
+  placeLabel(endLabel);
+  funcEndLabel_ = kNoCell;
 }
 
-void RPN::buildReturnCellRPN() {
-  RPNCell returnCell(CellType::ReturnCell, "return");
-  getLexem();
-  buildMathOperationRPN();
-  buildRPNCell(returnCell);
-  buildRPNCell(RPNCell(CellType::GoToCell, "end_func"));
-}
-
-void RPN::buildCallCeilRPN() {
-  RPNCell callCell(CellType::CallCeil, "call_ceil");
-  buildRPNCell(callCell);
-  FuncCalls.push(rpn_.size());
-  while (curLex_.get_text() != ")" && curLex_.get_type() != "NEWLINE") {
-    getLexem();
-    buildMathOperationRPN();
+/**
+ * @brief Emits a declaration as an assignment of its initial value, or of
+ * nothing, which the bytecode compiler turns into 0.
+ *
+ * @throws std::runtime_error for types and arrays the cells cannot hold
+ */
+void RPN::buildDeclarationRPN(const DeclarationNode& node) {
+  if (node.type != ValueType::Int && node.type != ValueType::Float &&
+      node.type != ValueType::String) {
+    throw std::runtime_error("Unexpected keyword: " +
+                             std::string(node.typeName));
   }
+  if (node.size != nullptr || !node.elements.empty()) {
+    throw std::runtime_error("Arrays are not supported: " +
+                             std::string(SymbolName(node.name)) +
+                             " on line " + std::to_string(node.line));
+  }
+  buildRPNCell(RPNCell(CellType::VarCell, std::string(SymbolName(node.name)),
+                       node.name));
+  if (node.value != nullptr) {
+    buildMathOperationRPN(*node.value);
+  }
+  buildRPNCell(RPNCell(CellType::MathCell, "="));
 }
 
-void RPN::buildConditionalJumpCellRPN() {
-  // Используется в if, while
-  RPNCell condJump(CellType::ConditionalJumpCell, "cond_jump");
-  buildRPNCell(condJump);
-}
-
-void RPN::buildLabelCellRPN() {
-  // Устанавливаем метку для переходов
-  RPNCell labelCell(CellType::LabelCell, "label");
-  buildRPNCell(labelCell);
-}
-
-void RPN::buildRPNCell(const RPNCell& cell) {
-  rpn_.push_back(cell);
+void RPN::buildAssignmentRPN(const AssignmentNode& node) {
+  buildRPNCell(RPNCell(CellType::VarCell, std::string(SymbolName(node.name)),
+                       node.name));
+  buildMathOperationRPN(*node.value);
+  buildRPNCell(RPNCell(CellType::MathCell, "="));
 }
 
-void RPN::getLexem() {
-  static size_t index = 0;
-  if (index < lexems_.size()) {
-    curLex_ = lexems_[index];
-    index++;
+/**
+ * @brief Emits a call statement: the cells of each argument, CallCeil(name)
+ * and a GoTo relocated against the FunctionCell of the callee.
+ */
+void RPN::buildCallRPN(const CallNode& node) {
+  for (const Expression* argument : node.arguments) {
+    buildMathOperationRPN(*argument);
   }
+  std::string name(SymbolName(node.name));
+  buildRPNCell(RPNCell(CellType::CallCeil, name, node.name));
+  relocations_.push_back(Relocation{rpn_.size(), node.name, true});
+  buildRPNCell(RPNCell(CellType::GoToCell, name));
 }
 
-int RPN::getPrecedence(const std::string& op) const {
-  if (op == "+" || op == "-")
-    return 1;
-  if (op == "*" || op == "/")
-    return 2;
-  return 0;
+void RPN::buildPrintRPN(const PrintNode& node) {
+  buildMathOperationRPN(*node.value);
+  buildRPNCell(RPNCell(CellType::FunctionCell, "print"));
 }
 
-std::vector<RPNCell> RPN::getRPN() {
-  return rpn_;
+void RPN::buildIfRPN(const IfNode& node) {
+  size_t falseLabel = newLabel("if_false");
+  size_t endLabel = newLabel("if_end");
+  buildMathOperationRPN(*node.condition);
+  buildJumpRPN(CellType::ConditionalJumpCell, falseLabel);
+  buildBlockRPN(node.then);
+  buildJumpRPN(CellType::GoToCell, endLabel);
+  placeLabel(falseLabel);
+  if (node.hasElse) {
+    buildBlockRPN(node.otherwise);
+  }
+  placeLabel(endLabel);
 }
 
-bool RPN::isOperator(const std::string& token) const {
-  return (token == "+" || token == "-" || token == "*" || token == "/");
+void RPN::buildWhileRPN(const WhileNode& node) {
+  size_t startLabel = newLabel("while_start");
+  size_t falseLabel = newLabel("while_false");
+  placeLabel(startLabel);
+  buildMathOperationRPN(*node.condition);
+  buildJumpRPN(CellType::ConditionalJumpCell, falseLabel);
+  buildBlockRPN(node.body);
+  buildJumpRPN(CellType::GoToCell, startLabel);
+  placeLabel(falseLabel);
 }
 
-bool RPN::isRelOp(const std::string& token) const {
-  return (token == "==" || token == "!=" || token == ">=" || token == "<=" ||
-          token == ">" || token == "<");
+void RPN::buildForRPN(const ForNode& node) {
+  size_t startLabel = newLabel("start_for");
+  size_t endLabel = newLabel("end_for");
+  std::string identifier(SymbolName(node.variable));
+  buildRPNCell(RPNCell(CellType::VarCell, identifier, node.variable));
+  buildRPNCell(RPNCell(CellType::ConstCell, "0"));
+  buildRPNCell(RPNCell(CellType::MathCell, "="));
+  placeLabel(startLabel);
+  buildRPNCell(RPNCell(CellType::LoadCell, identifier, node.variable));
+  buildMathOperationRPN(*node.bound);
+  buildRPNCell(RPNCell(Operator::Less, "<", 2));
+  buildJumpRPN(CellType::ConditionalJumpCell, endLabel);
+  buildBlockRPN(node.body);
+  buildRPNCell(RPNCell(CellType::VarCell, identifier, node.variable));
+  buildRPNCell(RPNCell(CellType::LoadCell, identifier, node.variable));
+  buildRPNCell(RPNCell(CellType::ConstCell, "1"));
+  buildRPNCell(RPNCell(Operator::Add, "+", 2));
+  buildRPNCell(RPNCell(CellType::MathCell, "="));
+  buildJumpRPN(CellType::GoToCell, startLabel);
+  placeLabel(endLabel);
 }
 
-bool RPN::isMathOp(const std::string& token) const {
-  return (token == "+" || token == "-" || token == "*" || token == "/");
+void RPN::buildReturnCellRPN(const ReturnNode& node) {
+  if (funcEndLabel_ == kNoCell) {
+    throw std::runtime_error("'return' outside of a function on line " +
+                             std::to_string(node.line));
+  }
+  buildMathOperationRPN(*node.value);
+  buildRPNCell(RPNCell(CellType::ReturnCell, "return"));
+  buildJumpRPN(CellType::GoToCell, funcEndLabel_);
 }
 
-bool RPN::isGoToCell(const std::string& token) const {
-  return (token == "goto");
+void RPN::buildRPNCell(const RPNCell& cell) {
+  rpn_.push_back(cell);
 }
 
-bool RPN::isReturnCell(const std::string& token) const {
-  return (token == "return");
+/**
+ * @brief Emits a jump to a label and records it in the relocation table;
+ * resolveLabels() replaces the label with the target cell index.
+ */
+void RPN::buildJumpRPN(CellType type, size_t label) {
+  relocations_.push_back(Relocation{rpn_.size(), label, false});
+  buildRPNCell(RPNCell(type, labelNames_[label]));
 }
 
-bool RPN::isCallCeil(const std::string& token) const {
-  return (token == "call");
+/**
+ * @brief Emits a LabelCell and records its position as the jump target.
+ */
+void RPN::placeLabel(size_t label) {
+  labelCells_[label] = rpn_.size();
+  buildRPNCell(RPNCell(CellType::LabelCell, labelNames_[label]));
 }
 
-bool RPN::isConditionalJumpCell(const std::string& token) const {
-  return (token == "if_goto" || token == "ifnot_goto");
+/**
+ * @brief Allocates a label that no other construct uses and returns its
+ * number; the LabelCell is named after it, e.g. while_start_3.
+ */
+size_t RPN::newLabel(const std::string& kind) {
+  labelNames_.push_back(kind + "_" + std::to_string(labelNames_.size()));
+  labelCells_.push_back(kNoCell);
+  return labelNames_.size() - 1;
 }
 
-bool RPN::isLabelCell(const std::string& token) const {
-  return (token == "label");
+std::vector<RPNCell> RPN::getRPN() {
+  return rpn_;
 }
-
-bool RPN::isNumber(const std::string& token) const {
-  if (token.empty())
-    return false;
-  for (char c : token) {
-    if (!isdigit(c) && c != '.')
-      return false;
-  }
-  return true;
-}
\ No newline at end of file
@@ -0,0 +1,329 @@
+#include "RegisterCode.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace {
+
+const uint32_t kMaxTarget = (1u << 24) - 1;
+
+uint16_t CheckedOperand(OperandKind kind, uint32_t index) {
+  if (index > kMaxOperandIndex) {
+    throw std::runtime_error("Program too large for the register format");
+  }
+  return MakeOperand(kind, index);
+}
+
+}  // namespace
+
+/**
+ * @brief Constructs a lowering pass for a compiled program.
+ *
+ * @param program Program produced by BytecodeCompiler::Compile(); it must
+ *        outlive the compiler
+ */
+RegisterCompiler::RegisterCompiler(const Program& program)
+    : program_(program) {}
+
+/**
+ * @brief Lowers the stack program into register code.
+ *
+ * @return RegisterProgram The lowered program
+ * @throws std::runtime_error on operand stack underflow or if an index does
+ *         not fit in an operand
+ */
+RegisterProgram RegisterCompiler::Compile() {
+  lowered_ = RegisterProgram();
+  lowered_.constants = program_.constants;
+  lowered_.globalNames = program_.globalNames;
+  lowered_.functions = program_.functions;
+  stack_.clear();
+  pending_.clear();
+  FindOwners();
+
+  const std::vector<Instruction>& code = program_.code;
+  stackToRegister_.assign(code.size() + 1, 0);
+  int current = -1;
+  EnterRegion(current);
+  for (uint32_t i = 0; i < code.size(); ++i) {
+    if (owner_[i] != current) {
+      LeaveRegion(current);
+      current = owner_[i];
+      EnterRegion(current);
+    } else if (targets_.count(i)) {
+      Flush();
+      lastDefined_ = -1;
+    }
+    stackToRegister_[i] = lowered_.code.size();
+
+    const Instruction instruction = code[i];
+    switch (instruction.op) {
+      case OpCode::PushConst:
+        Push(CheckedOperand(OperandKind::Constant, instruction.arg));
+        break;
+      case OpCode::LoadGlobal:
+        Push(CheckedOperand(OperandKind::Global, instruction.arg));
+        break;
+      case OpCode::LoadLocal:
+        Push(CheckedOperand(OperandKind::Register, instruction.arg));
+        break;
+      case OpCode::StoreGlobal:
+        Store(CheckedOperand(OperandKind::Global, instruction.arg));
+        break;
+      case OpCode::StoreLocal:
+        Store(CheckedOperand(OperandKind::Register, instruction.arg));
+        break;
+      case OpCode::Add:
+        Binary(RegOpCode::Add);
+        break;
+      case OpCode::Sub:
+        Binary(RegOpCode::Sub);
+        break;
+      case OpCode::Mul:
+        Binary(RegOpCode::Mul);
+        break;
+      case OpCode::Div:
+        Binary(RegOpCode::Div);
+        break;
+      case OpCode::Mod:
+        Binary(RegOpCode::Mod);
+        break;
+      case OpCode::Less:
+        Binary(RegOpCode::Less);
+        break;
+      case OpCode::Greater:
+        Binary(RegOpCode::Greater);
+        break;
+      case OpCode::LessEqual:
+        Binary(RegOpCode::LessEqual);
+        break;
+      case OpCode::GreaterEqual:
+        Binary(RegOpCode::GreaterEqual);
+        break;
+      case OpCode::Equal:
+        Binary(RegOpCode::Equal);
+        break;
+      case OpCode::NotEqual:
+        Binary(RegOpCode::NotEqual);
+        break;
+      case OpCode::And:
+        Binary(RegOpCode::And);
+        break;
+      case OpCode::Or:
+        Binary(RegOpCode::Or);
+        break;
+      case OpCode::Not:
+        Unary(RegOpCode::Not);
+        break;
+      case OpCode::Negate:
+        Unary(RegOpCode::Negate);
+        break;
+      case OpCode::Jump:
+        Flush();
+        jumpFixups_.emplace_back(lowered_.code.size(), instruction.arg);
+        Emit(RegOpCode::Jump);
+        break;
+      case OpCode::JumpIfFalse: {
+        uint16_t condition = Pop();
+        Flush();
+        jumpFixups_.emplace_back(lowered_.code.size(), instruction.arg);
+        Emit(RegOpCode::JumpIfFalse, 0, condition);
+        break;
+      }
+      case OpCode::Call: {
+        Flush();
+        uint32_t callee = program_.callSites[instruction.arg].function;
+        const FunctionInfo& function = program_.functions[callee];
+        if (stack_.size() < function.arity) {
+          throw std::runtime_error("Not enough arguments for function: " +
+                                   function.name);
+        }
+        size_t first = stack_.size() - function.arity;
+        Emit(RegOpCode::Call, callee, IndexOf(Temporary(first)));
+        stack_.resize(first);
+        break;
+      }
+      case OpCode::Return:
+        Pop();
+        Emit(RegOpCode::Leave);
+        break;
+      case OpCode::Leave:
+        Emit(RegOpCode::Leave);
+        break;
+      case OpCode::Print:
+        Emit(RegOpCode::Print, 0,
+             stack_.empty() ? MakeOperand(OperandKind::None, 0) : Pop());
+        break;
+    }
+  }
+  stackToRegister_[code.size()] = lowered_.code.size();
+  LeaveRegion(current);
+
+  for (const auto& [instruction, target] : jumpFixups_) {
+    lowered_.code[instruction].a = stackToRegister_[target];
+  }
+  jumpFixups_.clear();
+  for (FunctionInfo& function : lowered_.functions) {
+    function.entry = stackToRegister_[function.entry];
+  }
+  return std::move(lowered_);
+}
+
+/**
+ * @brief Records which function every instruction belongs to (-1 for top
+ * level code) and which instructions are jump targets.
+ *
+ * The body of a function runs from its entry to the first Leave, which
+ * BytecodeCompiler emits at its end_func label.
+ */
+void RegisterCompiler::FindOwners() {
+  const std::vector<Instruction>& code = program_.code;
+  owner_.assign(code.size(), -1);
+  targets_.clear();
+  for (size_t f = 0; f < program_.functions.size(); ++f) {
+    for (uint32_t i = program_.functions[f].entry; i < code.size(); ++i) {
+      owner_[i] = f;
+      if (code[i].op == OpCode::Leave) {
+        break;
+      }
+    }
+  }
+  for (const Instruction& instruction : code) {
+    if (instruction.op == OpCode::Jump ||
+        instruction.op == OpCode::JumpIfFalse) {
+      targets_.insert(instruction.arg);
+    }
+  }
+}
+
+/**
+ * @brief Starts lowering the code of a function, or resumes the top level
+ * code with the operands it had pending before the definition.
+ */
+void RegisterCompiler::EnterRegion(int function) {
+  if (function >= 0) {
+    pending_.swap(stack_);
+    stack_.clear();
+    base_ = program_.functions[function].frameSize;
+  } else {
+    stack_.swap(pending_);
+    pending_.clear();
+    base_ = 0;
+  }
+  maxDepth_ = stack_.size();
+  lastDefined_ = -1;
+}
+
+/**
+ * @brief Sizes the register file of the code lowered since EnterRegion().
+ */
+void RegisterCompiler::LeaveRegion(int function) {
+  Flush();
+  uint32_t registers = base_ + maxDepth_;
+  if (function < 0) {
+    lowered_.mainRegisters = std::max(lowered_.mainRegisters, registers);
+  } else {
+    lowered_.functions[function].frameSize = registers;
+  }
+}
+
+/**
+ * @brief Writes every pending operand to the temporary of its depth.
+ */
+void RegisterCompiler::Flush() {
+  for (size_t depth = 0; depth < stack_.size(); ++depth) {
+    Materialize(depth);
+  }
+}
+
+void RegisterCompiler::Materialize(size_t depth) {
+  uint16_t temporary = Temporary(depth);
+  if (stack_[depth] != temporary) {
+    Emit(RegOpCode::Move, temporary, stack_[depth]);
+    stack_[depth] = temporary;
+  }
+}
+
+void RegisterCompiler::Push(uint16_t operand) {
+  stack_.push_back(operand);
+  maxDepth_ = std::max<uint32_t>(maxDepth_, stack_.size());
+}
+
+/**
+ * @throws std::runtime_error if the simulated stack is empty
+ */
+uint16_t RegisterCompiler::Pop() {
+  if (stack_.empty()) {
+    throw std::runtime_error("Operand stack underflow");
+  }
+  uint16_t top = stack_.back();
+  stack_.pop_back();
+  return top;
+}
+
+/**
+ * @brief Returns the register holding the operand at a stack depth once it
+ * has been materialized.
+ */
+uint16_t RegisterCompiler::Temporary(size_t depth) {
+  maxDepth_ = std::max<uint32_t>(maxDepth_, depth + 1);
+  return CheckedOperand(OperandKind::Register, base_ + depth);
+}
+
+/**
+ * @brief Pops a value into a variable.
+ *
+ * Pending operands that still read the variable are materialized first.
+ * When the value is the temporary written by the instruction just emitted,
+ * that instruction writes the variable directly instead.
+ */
+void RegisterCompiler::Store(uint16_t destination) {
+  uint16_t value = Pop();
+  for (size_t depth = 0; depth < stack_.size(); ++depth) {
+    if (stack_[depth] == destination) {
+      Materialize(depth);
+    }
+  }
+  if (lastDefined_ >= 0 &&
+      static_cast<size_t>(lastDefined_) + 1 == lowered_.code.size() &&
+      lowered_.code[lastDefined_].a == value) {
+    lowered_.code[lastDefined_].a = destination;
+  } else {
+    Emit(RegOpCode::Move, destination, value);
+  }
+  lastDefined_ = -1;
+}
+
+/**
+ * @brief Emits `temporary = lhs op rhs` for the two topmost operands.
+ */
+void RegisterCompiler::Binary(RegOpCode op) {
+  uint16_t rhs = Pop();
+  uint16_t lhs = Pop();
+  uint16_t result = Temporary(stack_.size());
+  Emit(op, result, lhs, rhs);
+  lastDefined_ = lowered_.code.size() - 1;
+  Push(result);
+}
+
+/**
+ * @brief Emits `temporary = op operand` for the topmost operand.
+ */
+void RegisterCompiler::Unary(RegOpCode op) {
+  uint16_t operand = Pop();
+  uint16_t result = Temporary(stack_.size());
+  Emit(op, result, operand);
+  lastDefined_ = lowered_.code.size() - 1;
+  Push(result);
+}
+
+/**
+ * @brief Appends an instruction to the lowered program.
+ *
+ * @throws std::runtime_error if the program outgrows 24-bit targets
+ */
+void RegisterCompiler::Emit(RegOpCode op, uint32_t a, uint16_t b, uint16_t c) {
+  if (a > kMaxTarget || lowered_.code.size() > kMaxTarget) {
+    throw std::runtime_error("Program too large for the register format");
+  }
+  lowered_.code.push_back(RegInstruction{op, a, b, c});
+}
@@ -0,0 +1,187 @@
+#include "RegisterMachine.h"
+#include <iostream>
+#include <stdexcept>
+
+/**
+ * @brief Constructs a RegisterMachine for a lowered program.
+ *
+ * @param program Program produced by RegisterCompiler::Compile(); it must
+ *        outlive the machine
+ */
+RegisterMachine::RegisterMachine(const RegisterProgram& program)
+    : program_(program) {}
+
+/**
+ * @brief Executes the program from the first instruction until it falls
+ * off the end. Each call starts from a fresh machine state.
+ */
+void RegisterMachine::Run() {
+  registers_.assign(program_.mainRegisters, std::nullopt);
+  globals_.assign(program_.globalNames.size(), std::nullopt);
+  frames_.clear();
+  base_ = 0;
+  pc_ = 0;
+
+  const std::vector<RegInstruction>& code = program_.code;
+  while (pc_ < code.size()) {
+    const RegInstruction& instruction = code[pc_++];
+    switch (instruction.op) {
+      case RegOpCode::Move:
+        Write(instruction.a, Read(instruction.b));
+        break;
+      case RegOpCode::Add:
+        Binary(instruction, Operator::Add);
+        break;
+      case RegOpCode::Sub:
+        Binary(instruction, Operator::Sub);
+        break;
+      case RegOpCode::Mul:
+        Binary(instruction, Operator::Mul);
+        break;
+      case RegOpCode::Div:
+        Binary(instruction, Operator::Div);
+        break;
+      case RegOpCode::Mod:
+        Binary(instruction, Operator::Mod);
+        break;
+      case RegOpCode::Less:
+        Binary(instruction, Operator::Less);
+        break;
+      case RegOpCode::Greater:
+        Binary(instruction, Operator::Greater);
+        break;
+      case RegOpCode::LessEqual:
+        Binary(instruction, Operator::LessEqual);
+        break;
+      case RegOpCode::GreaterEqual:
+        Binary(instruction, Operator::GreaterEqual);
+        break;
+      case RegOpCode::Equal:
+        Binary(instruction, Operator::Equal);
+        break;
+      case RegOpCode::NotEqual:
+        Binary(instruction, Operator::NotEqual);
+        break;
+      case RegOpCode::And:
+        Binary(instruction, Operator::And);
+        break;
+      case RegOpCode::Or:
+        Binary(instruction, Operator::Or);
+        break;
+      case RegOpCode::Not:
+        Unary(instruction, Operator::Not);
+        break;
+      case RegOpCode::Negate:
+        Unary(instruction, Operator::Negate);
+        break;
+      case RegOpCode::Jump:
+        pc_ = instruction.a;
+        break;
+      case RegOpCode::JumpIfFalse:
+        if (!Read(instruction.b).IsTruthy()) {
+          pc_ = instruction.a;
+        }
+        break;
+      case RegOpCode::Call:
+        Call(instruction.a, instruction.b);
+        break;
+      case RegOpCode::Leave:
+        Leave();
+        break;
+      case RegOpCode::Print:
+        Print(instruction.b);
+        break;
+    }
+  }
+  std::cout.flush();
+}
+
+/**
+ * @brief Returns the value an operand refers to.
+ *
+ * @throws std::runtime_error if the variable was never assigned
+ */
+const Value& RegisterMachine::Read(uint32_t operand) const {
+  uint32_t index = IndexOf(operand);
+  switch (KindOf(operand)) {
+    case OperandKind::Constant:
+      return program_.constants[index];
+    case OperandKind::Global: {
+      const auto& value = globals_[index];
+      if (!value) {
+        throw std::runtime_error("Undefined variable: " +
+                                 program_.globalNames[index]);
+      }
+      return *value;
+    }
+    case OperandKind::Register: {
+      const auto& value = registers_[base_ + index];
+      if (!value) {
+        const auto& names =
+            program_.functions[frames_.back().function].localNames;
+        throw std::runtime_error("Undefined variable: " + names.at(index));
+      }
+      return *value;
+    }
+    default:
+      throw std::runtime_error("Read of an empty operand");
+  }
+}
+
+/**
+ * @brief Stores a value in a register or global operand.
+ */
+void RegisterMachine::Write(uint32_t operand, Value value) {
+  if (KindOf(operand) == OperandKind::Global) {
+    globals_[IndexOf(operand)] = std::move(value);
+  } else {
+    registers_[base_ + IndexOf(operand)] = std::move(value);
+  }
+}
+
+void RegisterMachine::Binary(const RegInstruction& instruction, Operator op) {
+  Write(instruction.a,
+        Value::Apply(op, Read(instruction.b), Read(instruction.c)));
+}
+
+void RegisterMachine::Unary(const RegInstruction& instruction, Operator op) {
+  Write(instruction.a, Value::Apply(op, Read(instruction.b)));
+}
+
+/**
+ * @brief Enters a user function: opens its register window and copies the
+ * arguments into its first registers.
+ *
+ * @param function Index into RegisterProgram::functions
+ * @param arguments First caller register holding an argument
+ */
+void RegisterMachine::Call(uint32_t function, uint32_t arguments) {
+  const FunctionInfo& info = program_.functions[function];
+  uint32_t base = registers_.size();
+  registers_.resize(base + info.frameSize);
+  for (uint32_t i = 0; i < info.arity; ++i) {
+    registers_[base + i] = registers_[base_ + arguments + i];
+  }
+  frames_.push_back(Frame{pc_, base_, function});
+  base_ = base;
+  pc_ = info.entry;
+}
+
+/**
+ * @brief Leaves the current function and resumes after its call site.
+ */
+void RegisterMachine::Leave() {
+  const Frame& frame = frames_.back();
+  registers_.resize(base_);
+  base_ = frame.callerBase;
+  pc_ = frame.returnAddress;
+  frames_.pop_back();
+}
+
+void RegisterMachine::Print(uint32_t operand) {
+  if (KindOf(operand) == OperandKind::None) {
+    std::cout << '\n';
+    return;
+  }
+  std::cout << Read(operand).ToString() << '\n';
+}
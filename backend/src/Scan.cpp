@@ -0,0 +1,229 @@
+#include "Scan.h"
+
+#if SIGMA_HAS_SIMD_SCAN
+#include <immintrin.h>
+#endif
+
+namespace {
+
+// Every class describes one kind of run: Class::Scalar() tests a byte,
+// Sse2Class() and Avx2Class() return a mask with 0xFF in the lanes of the
+// bytes in the class. Comparisons are signed, so bytes above 127 are
+// negative and fall outside every range.
+
+struct Identifier {
+  static bool Scalar(unsigned char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+           (c >= '0' && c <= '9') || c == '_';
+  }
+};
+
+struct Digits {
+  static bool Scalar(unsigned char c) { return c >= '0' && c <= '9'; }
+};
+
+struct Blanks {
+  static bool Scalar(unsigned char c) {
+    return c == ' ' || (c >= '\t' && c <= '\r' && c != '\n');
+  }
+};
+
+struct Spaces {
+  static bool Scalar(unsigned char c) { return c == ' '; }
+};
+
+struct Quote {
+  static bool Scalar(unsigned char c) { return c != '"'; }
+};
+
+template <typename Class>
+size_t ScalarSpan(const char* data, size_t begin, size_t end) {
+  while (begin < end &&
+         Class::Scalar(static_cast<unsigned char>(data[begin]))) {
+    ++begin;
+  }
+  return begin;
+}
+
+#if SIGMA_HAS_SIMD_SCAN
+
+__m128i InRange(__m128i x, char low, char high) {
+  return _mm_and_si128(_mm_cmpgt_epi8(x, _mm_set1_epi8(low - 1)),
+                       _mm_cmpgt_epi8(_mm_set1_epi8(high + 1), x));
+}
+
+__m128i Sse2Class(Identifier, __m128i x) {
+  __m128i lower = _mm_or_si128(x, _mm_set1_epi8(0x20));
+  return _mm_or_si128(
+      _mm_or_si128(InRange(lower, 'a', 'z'), InRange(x, '0', '9')),
+      _mm_cmpeq_epi8(x, _mm_set1_epi8('_')));
+}
+
+__m128i Sse2Class(Digits, __m128i x) {
+  return InRange(x, '0', '9');
+}
+
+__m128i Sse2Class(Blanks, __m128i x) {
+  __m128i control = _mm_andnot_si128(_mm_cmpeq_epi8(x, _mm_set1_epi8('\n')),
+                                     InRange(x, '\t', '\r'));
+  return _mm_or_si128(control, _mm_cmpeq_epi8(x, _mm_set1_epi8(' ')));
+}
+
+__m128i Sse2Class(Spaces, __m128i x) {
+  return _mm_cmpeq_epi8(x, _mm_set1_epi8(' '));
+}
+
+__m128i Sse2Class(Quote, __m128i x) {
+  return _mm_xor_si128(_mm_cmpeq_epi8(x, _mm_set1_epi8('"')),
+                       _mm_set1_epi8(-1));
+}
+
+template <typename Class>
+size_t Sse2Span(const char* data, size_t begin, size_t end) {
+  while (begin + 16 <= end) {
+    __m128i block =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + begin));
+    unsigned outside =
+        ~static_cast<unsigned>(_mm_movemask_epi8(Sse2Class(Class(), block))) &
+        0xFFFFu;
+    if (outside != 0) {
+      return begin + __builtin_ctz(outside);
+    }
+    begin += 16;
+  }
+  return ScalarSpan<Class>(data, begin, end);
+}
+
+#define SIGMA_AVX2 __attribute__((target("avx2")))
+
+SIGMA_AVX2 __m256i InRange(__m256i x, char low, char high) {
+  return _mm256_and_si256(_mm256_cmpgt_epi8(x, _mm256_set1_epi8(low - 1)),
+                          _mm256_cmpgt_epi8(_mm256_set1_epi8(high + 1), x));
+}
+
+SIGMA_AVX2 __m256i Avx2Class(Identifier, __m256i x) {
+  __m256i lower = _mm256_or_si256(x, _mm256_set1_epi8(0x20));
+  return _mm256_or_si256(
+      _mm256_or_si256(InRange(lower, 'a', 'z'), InRange(x, '0', '9')),
+      _mm256_cmpeq_epi8(x, _mm256_set1_epi8('_')));
+}
+
+SIGMA_AVX2 __m256i Avx2Class(Digits, __m256i x) {
+  return InRange(x, '0', '9');
+}
+
+SIGMA_AVX2 __m256i Avx2Class(Blanks, __m256i x) {
+  __m256i control =
+      _mm256_andnot_si256(_mm256_cmpeq_epi8(x, _mm256_set1_epi8('\n')),
+                          InRange(x, '\t', '\r'));
+  return _mm256_or_si256(control, _mm256_cmpeq_epi8(x, _mm256_set1_epi8(' ')));
+}
+
+SIGMA_AVX2 __m256i Avx2Class(Spaces, __m256i x) {
+  return _mm256_cmpeq_epi8(x, _mm256_set1_epi8(' '));
+}
+
+SIGMA_AVX2 __m256i Avx2Class(Quote, __m256i x) {
+  return _mm256_xor_si256(_mm256_cmpeq_epi8(x, _mm256_set1_epi8('"')),
+                          _mm256_set1_epi8(-1));
+}
+
+template <typename Class>
+SIGMA_AVX2 size_t Avx2Span(const char* data, size_t begin, size_t end) {
+  while (begin + 32 <= end) {
+    __m256i block =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + begin));
+    unsigned outside =
+        ~static_cast<unsigned>(_mm256_movemask_epi8(Avx2Class(Class(), block)));
+    if (outside != 0) {
+      return begin + __builtin_ctz(outside);
+    }
+    begin += 32;
+  }
+  return Sse2Span<Class>(data, begin, end);
+}
+
+#undef SIGMA_AVX2
+
+#endif  // SIGMA_HAS_SIMD_SCAN
+
+const ScanKernels kScalarKernels = {
+    ScanIsa::Scalar,    ScalarSpan<Identifier>, ScalarSpan<Digits>,
+    ScalarSpan<Blanks>, ScalarSpan<Spaces>,     ScalarSpan<Quote>};
+
+#if SIGMA_HAS_SIMD_SCAN
+const ScanKernels kSse2Kernels = {
+    ScanIsa::Sse2,    Sse2Span<Identifier>, Sse2Span<Digits>,
+    Sse2Span<Blanks>, Sse2Span<Spaces>,     Sse2Span<Quote>};
+
+const ScanKernels kAvx2Kernels = {
+    ScanIsa::Avx2,    Avx2Span<Identifier>, Avx2Span<Digits>,
+    Avx2Span<Blanks>, Avx2Span<Spaces>,     Avx2Span<Quote>};
+#endif
+
+const ScanKernels& KernelsFor(ScanIsa isa) {
+#if SIGMA_HAS_SIMD_SCAN
+  if (isa == ScanIsa::Avx2) {
+    return kAvx2Kernels;
+  }
+  if (isa == ScanIsa::Sse2) {
+    return kSse2Kernels;
+  }
+#endif
+  return kScalarKernels;
+}
+
+const ScanKernels*& ActiveKernels() {
+  static const ScanKernels* active = &KernelsFor(DetectScanIsa());
+  return active;
+}
+
+}  // namespace
+
+/**
+ * @brief Returns the widest instruction set the CPU supports.
+ */
+ScanIsa DetectScanIsa() {
+#if SIGMA_HAS_SIMD_SCAN
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2")) {
+    return ScanIsa::Avx2;
+  }
+  return ScanIsa::Sse2;
+#else
+  return ScanIsa::Scalar;
+#endif
+}
+
+/**
+ * @brief Switches the kernels used by lexers created afterwards.
+ *
+ * @param isa Requested instruction set; it is lowered to what the CPU
+ *        supports
+ * @return ScanIsa The instruction set actually selected
+ */
+ScanIsa UseScanIsa(ScanIsa isa) {
+  if (static_cast<int>(isa) > static_cast<int>(DetectScanIsa())) {
+    isa = DetectScanIsa();
+  }
+  ActiveKernels() = &KernelsFor(isa);
+  return isa;
+}
+
+/**
+ * @brief Returns the kernels selected at startup or by UseScanIsa().
+ */
+const ScanKernels& ActiveScanKernels() {
+  return *ActiveKernels();
+}
+
+const char* ScanIsaName(ScanIsa isa) {
+  switch (isa) {
+    case ScanIsa::Avx2:
+      return "avx2";
+    case ScanIsa::Sse2:
+      return "sse2";
+    default:
+      return "scalar";
+  }
+}
@@ -0,0 +1,92 @@
+#include "ScopeTable.h"
+
+namespace {
+
+constexpr size_t kInitialSlots = 64;
+
+}  // namespace
+
+ScopeTable::ScopeTable() : slots_(kInitialSlots) {}
+
+/**
+ * @brief Opens a scope; declarations made until the matching ExitScope()
+ * are undone by it.
+ */
+void ScopeTable::EnterScope() {
+  scopes_.push_back(bindings_.size());
+}
+
+/**
+ * @brief Closes the innermost scope, making visible again every binding
+ * its declarations shadowed. Does nothing when no scope is open.
+ */
+void ScopeTable::ExitScope() {
+  if (scopes_.empty()) {
+    return;
+  }
+  size_t mark = scopes_.back();
+  scopes_.pop_back();
+  while (bindings_.size() > mark) {
+    const Binding& binding = bindings_.back();
+    slots_[SlotOf(binding.name)].binding = binding.shadowed;
+    bindings_.pop_back();
+  }
+}
+
+/**
+ * @brief Declares a name in the innermost scope, shadowing any binding of
+ * the same name.
+ */
+void ScopeTable::Define(SymbolId name, ValueType type) {
+  if (2 * (names_ + 1) > slots_.size()) {
+    Grow();
+  }
+  Slot& slot = slots_[SlotOf(name)];
+  if (slot.name == kNoSymbol) {
+    slot.name = name;
+    ++names_;
+  }
+  bindings_.push_back(Binding{name, type, slot.binding});
+  slot.binding = bindings_.size() - 1;
+}
+
+/**
+ * @brief Returns the type of the innermost binding of a name, nothing if
+ * the name is not visible.
+ */
+std::optional<ValueType> ScopeTable::Find(SymbolId name) const {
+  uint32_t binding = slots_[SlotOf(name)].binding;
+  if (binding == kNone) {
+    return std::nullopt;
+  }
+  return bindings_[binding].type;
+}
+
+/**
+ * @brief Returns the slot of a name, or the free slot it would take.
+ *
+ * Slots are never freed: a name whose bindings are all undone keeps its
+ * slot with an empty chain, so probe sequences are never broken.
+ */
+size_t ScopeTable::SlotOf(SymbolId name) const {
+  size_t mask = slots_.size() - 1;
+  uint32_t hash = name * 2654435769u;
+  for (size_t i = (hash ^ (hash >> 16)) & mask;; i = (i + 1) & mask) {
+    if (slots_[i].name == name || slots_[i].name == kNoSymbol) {
+      return i;
+    }
+  }
+}
+
+/**
+ * @brief Doubles the table, keeping it at most half full.
+ */
+void ScopeTable::Grow() {
+  std::vector<Slot> slots(slots_.size() * 2);
+  slots.swap(slots_);
+  for (const Slot& slot : slots) {
+    if (slot.name != kNoSymbol) {
+      slots_[SlotOf(slot.name)] = slot;
+    }
+  }
+}
@@ -1,134 +1,88 @@
 #include "Semantic.h"
 #include <iostream>
 #include <stdexcept>
-#include "Lexem.h"
 
 /**
  * @brief Constructs a SemanticAnalyzer object.
  * 
- * This constructor initializes the SemanticAnalyzer with a vector of lexems.
- * It sets the current lexem to the first element in the vector and initializes
- * the scope stack with an empty scope.
+ * This constructor initializes the SemanticAnalyzer with the tree of a
+ * program; top-level variables are declared outside of any scope of the
+ * scope table and stay visible to the end.
  * 
- * @param lexems A reference to a vector of Lexem objects to be analyzed.
+ * @param ast The tree built by SyntaxAnalyzer; it is not copied, must
+ * outlive the analyzer and is annotated by Analyze().
  */
-SemanticAnalyzer::SemanticAnalyzer(std::vector<Lexem>& lexems)
-    : lexems_(lexems), curLex_(lexems[0]) {
-  scopeStack_.push_back({});
-}
+SemanticAnalyzer::SemanticAnalyzer(Ast& ast) : ast_(ast) {}
 
 /**
  * @brief Analyzes the semantic structure of the program.
  * 
- * This function initializes the analysis process by setting the index to 0,
- * calling the AnalyzeProgram function to perform the main analysis, and then
- * retrieving the next lexeme using the GetLexem function.
+ * Walks the top-level statements of the tree in order, checking them and
+ * annotating their expressions.
  */
 void SemanticAnalyzer::Analyze() {
-  index = 0;
-  AnalyzeProgram();
-  GetLexem();
+  AnalyzeBlock(ast_.program);
 }
 
 /**
- * @brief Retrieves the next lexeme from the list of lexemes.
+ * @brief Retrieves the type of a variable visible at the current point.
  *
- * This function updates the current lexeme (`curLex_`) to the next lexeme
- * in the `lexems_` list if the current index is within the bounds of the list.
- * The index is then incremented to point to the next lexeme for future calls.
- */
-void SemanticAnalyzer::GetLexem() {
-  if (index < lexems_.size()) {
-    curLex_ = lexems_[index++];
-  }
-}
-
-/**
- * @brief Enters a new scope by pushing an empty scope onto the scope stack.
- * 
- * This function is used to manage the scope stack within the semantic analyzer.
- * It creates a new, empty scope and adds it to the top of the stack, allowing
- * for the tracking of variables and other symbols within nested scopes.
- */
-void SemanticAnalyzer::EnterScope() {
-  scopeStack_.push_back({});
-}
-
-/**
- * @brief Exits the current scope by popping the top element from the scope stack.
+ * The innermost declaration of the name wins; the lookup costs the same
+ * whatever the depth of nesting.
  *
- * This function checks if the scope stack is not empty and then removes the 
- * top element, effectively exiting the current scope.
+ * @param var The id of the variable whose type is to be retrieved.
+ * @return The type of the variable, or nothing if the variable is not
+ *         defined in any open scope.
  */
-void SemanticAnalyzer::ExitScope() {
-  if (!scopeStack_.empty()) {
-    scopeStack_.pop_back();
-  }
+std::optional<ValueType> SemanticAnalyzer::FindVariable(SymbolId var) const {
+  return scopes_.Find(var);
 }
 
 /**
- * @brief Checks if a variable is defined in the current scope stack.
- *
- * This function iterates through the scope stack from the topmost scope to the bottommost scope
- * to determine if the specified variable is defined in any of the scopes.
- *
- * @param var The name of the variable to check.
- * @return true if the variable is defined in any scope; false otherwise.
+ * @brief Adds a variable with its type to the current scope.
+ * 
+ * This function declares a variable in the innermost scope of the scope
+ * table and records it for GetVariableTypes().
+ * 
+ * @param var The id of the variable to be added.
+ * @param type The type of the variable to be added.
  */
-bool SemanticAnalyzer::IsVarDefined(const std::string& var) {
-  for (int i = static_cast<int>(scopeStack_.size()) - 1; i >= 0; --i) {
-    if (scopeStack_[i].find(var) != scopeStack_[i].end()) {
-      return true;
-    }
-  }
-  return false;
+void SemanticAnalyzer::AddVariable(SymbolId var, ValueType type) {
+  scopes_.Define(var, type);
+  variableTypes_[currentFunction_][var] = type;
 }
 
 /**
- * @brief Retrieves the type of a given variable from the scope stack.
+ * @brief Returns the declared type of every variable, per function.
  *
- * This function searches through the scope stack from the most recent scope
- * to the oldest scope to find the type of the specified variable. If the
- * variable is found, its type is returned. If the variable is not found in
- * any scope, an empty string is returned.
+ * Unlike the scope table this record survives the analysis. Variables
+ * declared outside of any function are stored under kNoSymbol.
  *
- * @param var The name of the variable whose type is to be retrieved.
- * @return The type of the variable as a string, or an empty string if the
- *         variable is not found in any scope.
+ * @return Map from function id to a map of variable ids to types
  */
-std::string SemanticAnalyzer::GetVarType(const std::string& var) {
-  for (int i = static_cast<int>(scopeStack_.size()) - 1; i >= 0; --i) {
-    if (scopeStack_[i].find(var) != scopeStack_[i].end()) {
-      return scopeStack_[i][var];
-    }
-  }
-  return "";
+const std::map<SymbolId, std::map<SymbolId, ValueType>>&
+SemanticAnalyzer::GetVariableTypes() const {
+  return variableTypes_;
 }
 
 /**
- * @brief Adds a variable with its type to the current scope.
- * 
- * This function inserts a variable and its corresponding type into the 
- * most recent scope in the scope stack.
- * 
- * @param var The name of the variable to be added.
- * @param type The type of the variable to be added.
+ * @brief Returns the parameter types of every analyzed function.
  */
-void SemanticAnalyzer::AddVariable(const std::string& var,
-                                   const std::string& type) {
-  scopeStack_.back()[var] = type;
+const std::map<SymbolId, std::vector<ValueType>>&
+SemanticAnalyzer::GetFunctionSignatures() const {
+  return functionSignatures_;
 }
 
 /**
- * @brief Analyzes the entire program by iterating through each statement.
+ * @brief Analyzes the statements of a block in order.
  * 
- * This function continuously analyzes statements in the program until 
- * the end of the code (EOC) is reached. It relies on the AnalyzeStatement 
- * function to process each individual statement.
+ * This function analyzes the statements of the top-level program or of the
+ * body of a compound statement, relying on the AnalyzeStatement function to
+ * process each individual statement.
  */
-void SemanticAnalyzer::AnalyzeProgram() {
-  while (curLex_.get_type() != "EOC") {
-    AnalyzeStatement();
+void SemanticAnalyzer::AnalyzeBlock(const Block& block) {
+  for (Statement* statement : block) {
+    AnalyzeStatement(*statement);
   }
 }
 
@@ -143,9 +97,9 @@ void SemanticAnalyzer::AnalyzeProgram() {
 void SemanticAnalyzer::PrintFunction() {
   std::cout << "Semantic function signatures:" << std::endl;
   for (const auto& [name, types] : functionSignatures_) {
-    std::cout << name << "(";
+    std::cout << SymbolName(name) << "(";
     for (size_t i = 0; i < types.size(); i++) {
-      std::cout << types[i];
+      std::cout << ValueTypeName(types[i]);
       if (i < types.size() - 1) {
         std::cout << ", ";
       }
@@ -157,8 +111,8 @@ void SemanticAnalyzer::PrintFunction() {
 /**
  * @brief Analyzes a single statement in the source code.
  * 
- * This function processes the current lexical token and determines the type of statement it represents.
- * Depending on the type of statement, it delegates the analysis to the appropriate function.
+ * This function looks at the kind of the statement node and delegates the
+ * analysis to the appropriate function.
  * 
  * @throws std::runtime_error if an invalid keyword is encountered, or if there are issues with function calls or variable assignments.
  * 
@@ -171,230 +125,159 @@ void SemanticAnalyzer::PrintFunction() {
  * - If statement (`if`)
  * - For loop (`for`)
  * 
- * Additionally, it handles function calls and variable assignments for identifiers.
- * 
- * @note This function assumes that `curLex_` is properly initialized and points to the current lexical token.
+ * Additionally, it handles function calls and variable assignments.
  */
-void SemanticAnalyzer::AnalyzeStatement() {
-  if (curLex_.get_type() == "KEYWORD") {
-    auto keyword = curLex_.get_text();
-    if (keyword == "def") {
-      GetLexem();
-      AnalyzeFunction();
-    } else if (keyword == "int" || keyword == "float" || keyword == "string") {
-      AnalyzeVariableDeclaration();
-    } else if (keyword == "print") {
-      AnalyzePrint();
-    } else if (keyword == "return") {
-      GetLexem();
-      AnalyzeExpression();
-    } else if (keyword == "while") {
-      AnalyzeWhile();
-    } else if (keyword == "if") {
-      AnalyzeIf();
-    } else if (keyword == "for") {
-      AnalyzeFor();
-    } else {
-      throw std::runtime_error("Invalid keyword: " + keyword + "\nOn line: " +
-                               std::to_string(curLex_.get_line()));
-    }
-  }
-  if (curLex_.get_type() == "IDENTIFIER") {
-    auto name = curLex_.get_text();
-    GetLexem();
-    if (curLex_.get_text() == "(") {
-      if (functionSignatures_.find(name) == functionSignatures_.end()) {
-        throw std::runtime_error("Undefined function: " + name + "\nOn line: " +
-                                 std::to_string(curLex_.get_line()));
-      }
-      auto argTypes = functionSignatures_[name];
-      CheckFunctionCall(name);
-    } else if (curLex_.get_text() == "=") {
-      GetLexem();
-      if (!IsVarDefined(name)) {
-        throw std::runtime_error("Undefined variable: " + name + "\nOn line: " +
-                                 std::to_string(curLex_.get_line()));
-      }
-      if (GetVarType(name) == "int" || GetVarType(name) == "float") {
-        if (curLex_.get_type() == "STRING") {
-          throw std::runtime_error(
-              "Cannot assign string to " + GetVarType(name) + " variable: " +
-              name + "\nOn line: " + std::to_string(curLex_.get_line()));
-        }
-      }
-      if (GetVarType(name) == "string") {
-        if (curLex_.get_type() == "NUMBER") {
-          throw std::runtime_error(
-              "Cannot assign number to string variable: " + name +
-              "\nOn line: " + std::to_string(curLex_.get_line()));
-        }
-      }
-      AnalyzeExpression();
-    } else {
-      throw std::runtime_error("Invalid statement: " + name + "\nOn line: " +
-                               std::to_string(curLex_.get_line()));
-    }
-  }
-  if (curLex_.get_type() == "NEWLINE" || curLex_.get_text() == ";" ||
-      curLex_.get_text() == "}") {
-    GetLexem();
+void SemanticAnalyzer::AnalyzeStatement(Statement& statement) {
+  switch (statement.kind) {
+    case NodeKind::Function:
+      AnalyzeFunction(static_cast<FunctionNode&>(statement));
+      break;
+    case NodeKind::Declaration:
+      AnalyzeVariableDeclaration(static_cast<DeclarationNode&>(statement));
+      break;
+    case NodeKind::Assignment:
+      AnalyzeAssignment(static_cast<AssignmentNode&>(statement));
+      break;
+    case NodeKind::Call:
+      CheckFunctionCall(static_cast<CallNode&>(statement));
+      break;
+    case NodeKind::Print:
+      AnalyzePrint(static_cast<PrintNode&>(statement));
+      break;
+    case NodeKind::Return:
+      AnalyzeExpression(*static_cast<ReturnNode&>(statement).value);
+      break;
+    case NodeKind::While:
+      AnalyzeWhile(static_cast<WhileNode&>(statement));
+      break;
+    case NodeKind::If:
+      AnalyzeIf(static_cast<IfNode&>(statement));
+      break;
+    case NodeKind::For:
+      AnalyzeFor(static_cast<ForNode&>(statement));
+      break;
+    case NodeKind::Jump:
+      throw std::runtime_error(
+          "Invalid keyword: " +
+          std::string(static_cast<JumpNode&>(statement).text) +
+          "\nOn line: " + std::to_string(statement.line));
   }
 }
 
 /**
- * @brief Checks the validity of a function call in the source code.
+ * @brief Analyzes an assignment to a variable.
  *
- * This function verifies that the function being called is defined, that the
- * correct syntax is used for the function call, and that the arguments passed
- * to the function match the expected types and number of arguments.
+ * The variable must be declared, and a string literal cannot be assigned
+ * to a number nor a number literal to a string. The declared type of the
+ * variable is recorded in the node.
  *
- * @param funcName The name of the function being called.
- *
- * @throws std::runtime_error If the function is undefined, if the syntax of
- * the function call is incorrect, if an undefined variable is used as an
- * argument, if the number of arguments does not match the function signature,
- * or if the types of the arguments do not match the expected types.
+ * @throws std::runtime_error if the variable is undefined or the first
+ * operand of the value does not fit its type.
  */
-void SemanticAnalyzer::CheckFunctionCall(const std::string& funcName) {
-  if (functionSignatures_.find(funcName) == functionSignatures_.end()) {
-    throw std::runtime_error("Undefined function: " + funcName);
-  }
-  if (curLex_.get_text() != "(") {
-    throw std::runtime_error(
-        "Expected '(' after function name: " + funcName +
-        "\nOn line: " + std::to_string(curLex_.get_line()));
-  }
-  GetLexem();
-  std::vector<std::string> argTypes;
-  while (curLex_.get_text() != ")") {
-    if (curLex_.get_type() == "NUMBER") {
-      argTypes.push_back((curLex_.get_text().find('.') != std::string::npos)
-                             ? "float"
-                             : "int");
-    } else if (curLex_.get_type() == "STRING") {
-      argTypes.push_back("string");
-    } else if (curLex_.get_type() == "IDENTIFIER") {
-      if (!IsVarDefined(curLex_.get_text())) {
-        throw std::runtime_error(
-            "Undefined variable: " + curLex_.get_text() +
-            "\nOn line: " + std::to_string(curLex_.get_line()));
-      }
-      argTypes.push_back(GetVarType(curLex_.get_text()));
-    }
-    AnalyzeExpression();
-    if (curLex_.get_text() != "," && curLex_.get_text() != ")") {
+void SemanticAnalyzer::AnalyzeAssignment(AssignmentNode& node) {
+  std::string name(SymbolName(node.name));
+  std::optional<ValueType> declared = FindVariable(node.name);
+  if (!declared) {
+    throw std::runtime_error("Undefined variable: " + name + "\nOn line: " +
+                             std::to_string(node.line));
+  }
+  ValueType type = *declared;
+  node.target = type;
+  const Span<Lexem>& value = node.value->tokens;
+  if (!value.empty()) {
+    if ((type == ValueType::Int || type == ValueType::Float) &&
+        value.front().get_type() == LexemType::STRING) {
       throw std::runtime_error(
-          "Expected ',' or ')' after argument \nOn line: " +
-          std::to_string(curLex_.get_line()));
+          "Cannot assign string to " + std::string(ValueTypeName(type)) +
+          " variable: " + name +
+          "\nOn line: " + std::to_string(value.front().get_line()));
     }
-    if (curLex_.get_text() == ",") {
-      GetLexem();
+    if (type == ValueType::String &&
+        value.front().get_type() == LexemType::NUMBER) {
+      throw std::runtime_error(
+          "Cannot assign number to string variable: " + name +
+          "\nOn line: " + std::to_string(value.front().get_line()));
     }
   }
-  if (argTypes.size() != functionSignatures_[funcName].size()) {
+  AnalyzeExpression(*node.value);
+}
+
+/**
+ * @brief Checks the validity of a function call in the source code.
+ *
+ * This function verifies that the function being called is defined and that
+ * the arguments passed to the function match the expected types and number
+ * of arguments. The type of an argument is the one AnalyzeExpression()
+ * records for it; an argument of unknown type is not checked.
+ *
+ * @param call The call statement.
+ *
+ * @throws std::runtime_error If the function is undefined, if an undefined
+ * variable is used as an argument, if the number of arguments does not match
+ * the function signature, or if the types of the arguments do not match the
+ * expected types.
+ */
+void SemanticAnalyzer::CheckFunctionCall(const CallNode& call) {
+  auto signature = functionSignatures_.find(call.name);
+  std::string funcName(SymbolName(call.name));
+  if (signature == functionSignatures_.end()) {
+    throw std::runtime_error("Undefined function: " + funcName +
+                             "\nOn line: " + std::to_string(call.line));
+  }
+  const std::vector<ValueType>& expected = signature->second;
+  std::vector<ValueType> argTypes;
+  for (Expression* argument : call.arguments) {
+    AnalyzeExpression(*argument);
+    argTypes.push_back(argument->type);
+  }
+  if (argTypes.size() != expected.size()) {
     throw std::runtime_error(
         "Invalid number of arguments for function: " + funcName +
-        "\nOn line: " + std::to_string(curLex_.get_line()) +
-        "\nExpected: " + std::to_string(functionSignatures_[funcName].size()) +
+        "\nOn line: " + std::to_string(call.line) +
+        "\nExpected: " + std::to_string(expected.size()) +
         "\nGot: " + std::to_string(argTypes.size()));
   }
   for (int i = 0; i < (int)argTypes.size(); i++) {
-    if (argTypes[i] != functionSignatures_[funcName][i]) {
+    if (argTypes[i] != ValueType::Unknown && argTypes[i] != expected[i]) {
       throw std::runtime_error(
           "Invalid argument type for function: " + funcName +
-          "\nOn line: " + std::to_string(curLex_.get_line()) + "\nExpected: " +
-          functionSignatures_[funcName][i] + "\nGot: " + argTypes[i]);
+          "\nOn line: " + std::to_string(call.line) + "\nExpected: " +
+          ValueTypeName(expected[i]) + "\nGot: " + ValueTypeName(argTypes[i]));
     }
   }
-  GetLexem();
 }
 
 /**
  * @brief Analyzes a function declaration and its body.
  * 
- * This function performs semantic analysis on a function declaration. It checks for the correct
- * syntax and structure of the function, including the function name, argument types, and the 
- * function body. It also manages the scope of the function and its parameters.
+ * This function performs semantic analysis on a function declaration. It
+ * records the signature of the function before its body is analyzed, so the
+ * function may call itself, and manages the scope of the function and its
+ * parameters.
  * 
- * @throws std::runtime_error if any syntax or semantic errors are encountered during analysis.
+ * @throws std::runtime_error if any semantic errors are encountered.
  * 
  * The function performs the following steps:
- * 1. Skips any leading keywords.
- * 2. Validates the function name.
- * 3. Checks for the opening parenthesis '(' after the function name.
- * 4. Parses and validates the argument types.
- * 5. Checks for the closing parenthesis ')' after the argument list.
- * 6. Stores the function signature.
- * 7. Checks for the colon ':' after the function signature.
- * 8. Validates the presence of an indented block for the function body.
- * 9. Enters a new scope for the function.
- * 10. Adds the function parameters to the scope.
- * 11. Analyzes the statements within the function body.
- * 12. Exits the scope after the function body is analyzed.
+ * 1. Stores the function signature.
+ * 2. Enters a new scope for the function.
+ * 3. Adds the function parameters to the scope.
+ * 4. Analyzes the statements within the function body.
+ * 5. Exits the scope after the function body is analyzed.
  */
-void SemanticAnalyzer::AnalyzeFunction() {
-  while (curLex_.get_type() == "KEYWORD") {
-    GetLexem();
-  }
-  if (curLex_.get_type() != "IDENTIFIER") {
-    throw std::runtime_error(
-        "Invalid function name: " + curLex_.get_text() +
-        "\nOn line: " + std::to_string(curLex_.get_line()));
-  }
-  std::string funcName = curLex_.get_text();
-  GetLexem();
-  if (curLex_.get_text() != "(") {
-    throw std::runtime_error(
-        "Expected '(' after function name, got: " + curLex_.get_text() +
-        "\nOn line: " + std::to_string(curLex_.get_line()));
-  }
-  GetLexem();
-  std::vector<std::string> argTypes;
-  while (curLex_.get_text() != ")") {
-    if (curLex_.get_type() != "KEYWORD") {
-      throw std::runtime_error(
-          "Invalid argument type: " + curLex_.get_text() +
-          "\nOn line: " + std::to_string(curLex_.get_line()));
-    }
-    argTypes.push_back(curLex_.get_text());
-    GetLexem();
-    GetLexem();
-    if (curLex_.get_text() != "," && curLex_.get_text() != ")") {
-      throw std::runtime_error(
-          "Expected ',' or ')' after argument type. \nOn line: " +
-          std::to_string(curLex_.get_line()));
-    }
-    if (curLex_.get_text() == ",") {
-      GetLexem();
-    }
-  }
-  GetLexem();
-  functionSignatures_[funcName] = argTypes;
-  if (curLex_.get_text() != ":") {
-    throw std::runtime_error(
-        "Expected ':' after function signature \n On line: " +
-        std::to_string(curLex_.get_line()));
-  }
-  GetLexem();
-  GetLexem();
-  if (curLex_.get_type() != "INDENT") {
-    throw std::runtime_error(
-        "Expected indented block after function declaration \nOn line: " +
-        std::to_string(curLex_.get_line()));
-  }
-  EnterScope();
-  for (int i = 0; i < (int)argTypes.size(); i++) {
-    std::string paramName = "param" + std::to_string(i + 1);
-    AddVariable(paramName, argTypes[i]);
-  }
-  GetLexem();
-  while (curLex_.get_type() != "DEDENT" && curLex_.get_type() != "EOC") {
-    AnalyzeStatement();
-  }
-  if (curLex_.get_type() == "DEDENT") {
-    GetLexem();
-  }
-  ExitScope();
+void SemanticAnalyzer::AnalyzeFunction(FunctionNode& node) {
+  std::vector<ValueType> argTypes;
+  for (const Parameter& parameter : node.parameters) {
+    argTypes.push_back(FindValueType(parameter.type));
+  }
+  functionSignatures_[node.name] = argTypes;
+  scopes_.EnterScope();
+  currentFunction_ = node.name;
+  for (const Parameter& parameter : node.parameters) {
+    AddVariable(parameter.name, FindValueType(parameter.type));
+  }
+  AnalyzeBlock(node.body);
+  currentFunction_ = kNoSymbol;
+  scopes_.ExitScope();
 }
 
 /**
@@ -402,49 +285,44 @@ void SemanticAnalyzer::AnalyzeFunction() {
  * 
  * This function processes the declaration of a variable, including its type,
  * name, and optional initialization. It performs several checks to ensure
- * the declaration is valid, such as verifying the variable name, checking for
- * redefinition, and ensuring proper syntax for array declarations and initializations.
+ * the declaration is valid, such as checking for redefinition and analyzing
+ * the size and the elements of an array.
  * 
- * @throws std::runtime_error if the variable name is invalid, if the variable
- *         is redefined, if there are syntax errors in the array declaration,
- *         or if there is a type mismatch during initialization.
+ * @throws std::runtime_error if the type cannot be declared, if the variable
+ *         is redefined, or if there is a type mismatch during initialization.
  */
-void SemanticAnalyzer::AnalyzeVariableDeclaration() {
-  auto type = curLex_.get_text();
-  while (curLex_.get_type() == "KEYWORD") {
-    GetLexem();
-  }
-  if (curLex_.get_type() != "IDENTIFIER") {
-    throw std::runtime_error(
-        "Invalid variable name: " + curLex_.get_text() +
-        "\nOn line: " + std::to_string(curLex_.get_line()));
-  }
-  std::string varName = curLex_.get_text();
-  if (IsVarDefined(varName)) {
+void SemanticAnalyzer::AnalyzeVariableDeclaration(DeclarationNode& node) {
+  ValueType type = node.type;
+  if (type != ValueType::Int && type != ValueType::Float &&
+      type != ValueType::String) {
+    throw std::runtime_error("Invalid keyword: " +
+                             std::string(node.typeName) + "\nOn line: " +
+                             std::to_string(node.line));
+  }
+  std::string varName(SymbolName(node.name));
+  if (FindVariable(node.name)) {
     throw std::runtime_error(
         "Variable redefinition: " + varName +
-        "\nOn line: " + std::to_string(curLex_.get_line()));
+        "\nOn line: " + std::to_string(node.line));
   }
-  GetLexem();
-  if (curLex_.get_text() == "[") {
-    GetLexem();
-    AnalyzeExpression();
-    if (curLex_.get_text() != "]") {
-      throw std::runtime_error("Expected ']' after array size \n On line: " +
-                               std::to_string(curLex_.get_line()));
-    }
-    GetLexem();
+  if (node.size != nullptr) {
+    AnalyzeExpression(*node.size);
   }
-  if (curLex_.get_text() == "=") {
-    GetLexem();
-    if ((type == "int" || type == "float") && curLex_.get_type() == "STRING") {
+  for (Expression* element : node.elements) {
+    AnalyzeExpression(*element);
+  }
+  if (node.value != nullptr) {
+    const Span<Lexem>& value = node.value->tokens;
+    if ((type == ValueType::Int || type == ValueType::Float) &&
+        !value.empty() && value.front().get_type() == LexemType::STRING) {
       throw std::runtime_error(
-          "Cannot assign string to " + type + " variable: " + varName +
-          "\nOn line: " + std::to_string(curLex_.get_line()));
+          "Cannot assign string to " + std::string(ValueTypeName(type)) +
+          " variable: " + varName +
+          "\nOn line: " + std::to_string(value.front().get_line()));
     }
-    AnalyzeExpression();
+    AnalyzeExpression(*node.value);
   }
-  AddVariable(varName, type);
+  AddVariable(node.name, type);
 }
 
 /**
@@ -454,289 +332,177 @@ void SemanticAnalyzer::AnalyzeVariableDeclaration() {
  * to ensure they are used correctly. It throws runtime errors if it encounters
  * undefined variables or type mismatches in addition operations.
  * 
- * The function processes the expression until it encounters a newline, 
- * semicolon, closing parenthesis, comma, closing bracket, end of code, 
- * or closing brace.
+ * The type of the value is recorded in the expression: bool if it compares
+ * or applies a logical operator, otherwise the widest type of its operands
+ * (string, float, int).
  * 
  * @throws std::runtime_error if an undefined variable is encountered or 
  *         if there is a type mismatch in an addition operation.
  */
-void SemanticAnalyzer::AnalyzeExpression() {
-  std::string leftType;
-  while (curLex_.get_type() != "NEWLINE" && curLex_.get_text() != ";" &&
-         curLex_.get_text() != ")" && curLex_.get_text() != "," &&
-         curLex_.get_text() != "]" && curLex_.get_type() != "EOC" &&
-         curLex_.get_text() != "}") {
-    if (curLex_.get_type() == "IDENTIFIER") {
-      if (!IsVarDefined(curLex_.get_text())) {
+void SemanticAnalyzer::AnalyzeExpression(Expression& expression) {
+  const Span<Lexem>& tokens = expression.tokens;
+  ValueType valueType = ValueType::Unknown;
+  bool compares = false;
+  ValueType leftType = ValueType::Unknown;
+  // The name of a call is not a variable; its value has no known type
+  auto typeAt = [&](size_t i) {
+    if (i + 1 < tokens.size &&
+        tokens[i + 1].get_symbol() == Symbol::LeftParen) {
+      if (tokens[i].get_type() == LexemType::IDENTIFIER &&
+          !functionSignatures_.count(tokens[i].get_id())) {
         throw std::runtime_error(
-            "Undefined variable: " + curLex_.get_text() +
-            "\nOn line: " + std::to_string(curLex_.get_line()));
+            "Undefined function: " + std::string(tokens[i].get_text()) +
+            "\nOn line: " + std::to_string(tokens[i].get_line()));
+      }
+      return ValueType::Unknown;
+    }
+    return OperandType(tokens[i]);
+  };
+  for (size_t i = 0; i < tokens.size; ++i) {
+    Symbol symbol = tokens[i].get_symbol();
+    Keyword keyword = tokens[i].get_keyword();
+    compares = compares ||
+               (symbol >= Symbol::Less && symbol <= Symbol::Or) ||
+               keyword == Keyword::And || keyword == Keyword::Or ||
+               keyword == Keyword::Not;
+    ValueType operand = typeAt(i);
+    if (operand != ValueType::Unknown) {
+      leftType = operand;
+      if (valueType == ValueType::Unknown || operand == ValueType::String ||
+          (operand == ValueType::Float && valueType == ValueType::Int)) {
+        valueType = operand;
       }
-      leftType = GetVarType(curLex_.get_text());
-    } else if (curLex_.get_type() == "NUMBER") {
-      leftType =
-          (curLex_.get_text().find('.') != std::string::npos) ? "float" : "int";
-    } else if (curLex_.get_type() == "STRING") {
-      leftType = "string";
     }
-    GetLexem();
 
-    if (curLex_.get_text() == "+") {
-      GetLexem();
-      std::string rightType;
-      if (curLex_.get_type() == "IDENTIFIER") {
-        if (!IsVarDefined(curLex_.get_text())) {
-          throw std::runtime_error(
-              "Undefined variable: " + curLex_.get_text() +
-              "\nOn line: " + std::to_string(curLex_.get_line()));
-        }
-        rightType = GetVarType(curLex_.get_text());
-      } else if (curLex_.get_type() == "NUMBER") {
-        rightType = (curLex_.get_text().find('.') != std::string::npos)
-                        ? "float"
-                        : "int";
-      } else if (curLex_.get_type() == "STRING") {
-        rightType = "string";
+    if (i + 1 < tokens.size && tokens[i + 1].get_symbol() == Symbol::Plus) {
+      ++i;
+      ValueType rightType = ValueType::Unknown;
+      size_t line = tokens[i].get_line();
+      if (i + 1 < tokens.size) {
+        rightType = typeAt(i + 1);
+        line = tokens[i + 1].get_line();
       }
-      if (leftType != rightType &&
-          !(leftType == "float" && rightType == "int") &&
-          !(leftType == "int" && rightType == "float")) {
+      bool numbers =
+          (leftType == ValueType::Int || leftType == ValueType::Float) &&
+          (rightType == ValueType::Int || rightType == ValueType::Float);
+      if (leftType != rightType && !numbers) {
         throw std::runtime_error(
-            "Type mismatch in addition: cannot add " + leftType + " and " +
-            rightType + "\nOn line: " + std::to_string(curLex_.get_line()));
+            "Type mismatch in addition: cannot add " +
+            std::string(ValueTypeName(leftType)) + " and " +
+            ValueTypeName(rightType) + "\nOn line: " + std::to_string(line));
       }
     }
   }
+  expression.type = compares ? ValueType::Bool : valueType;
 }
 
 /**
- * @brief Analyzes the syntax and semantics of a print statement.
- * 
- * This function processes a print statement by verifying the correct syntax
- * and types of its arguments. It expects the print statement to start with
- * a '(' and end with a ')'. The arguments within the parentheses must be
- * identifiers, numbers, or strings, separated by commas.
- * 
- * @throws std::runtime_error if the syntax is incorrect or if an invalid 
- * argument type is encountered.
+ * @brief Returns the type of an operand of an expression.
+ *
+ * Numbers are float when they have a decimal point and int otherwise.
+ *
+ * @param operand The lexem of the operand.
+ * @return The declared type of a variable, the type of a literal, or
+ *         ValueType::Unknown for any other lexem.
+ * @throws std::runtime_error if the operand is an undefined variable.
  */
-void SemanticAnalyzer::AnalyzePrint() {
-  GetLexem();
-  while (curLex_.get_type() == "KEYWORD") {
-    GetLexem();
-  }
-  if (curLex_.get_text() != "(") {
-    throw std::runtime_error("Expected '(' after print \n On line: " +
-                             std::to_string(curLex_.get_line()));
-  }
-  GetLexem();
-  std::vector<std::string> argTypes;
-  while (curLex_.get_text() != ")") {
-    if (curLex_.get_type() != "IDENTIFIER" && curLex_.get_type() != "NUMBER" &&
-        curLex_.get_type() != "STRING") {
+ValueType SemanticAnalyzer::OperandType(const Lexem& operand) {
+  if (operand.get_type() == LexemType::IDENTIFIER) {
+    std::optional<ValueType> type = FindVariable(operand.get_id());
+    if (!type) {
       throw std::runtime_error(
-          "Invalid argument for print: " + curLex_.get_text() +
-          "\nOn line: " + std::to_string(curLex_.get_line()));
-    }
-    argTypes.push_back(curLex_.get_type());
-    GetLexem();
-    if (curLex_.get_text() != "," && curLex_.get_text() != ")") {
-      throw std::runtime_error(
-          "Expected ',' or ')' after argument \n On line: " +
-          std::to_string(curLex_.get_line()));
+          "Undefined variable: " + std::string(operand.get_text()) +
+          "\nOn line: " + std::to_string(operand.get_line()));
     }
+    return *type;
+  }
+  if (operand.get_type() == LexemType::NUMBER) {
+    return operand.get_text().find('.') != std::string::npos
+               ? ValueType::Float
+               : ValueType::Int;
   }
-  GetLexem();
-  GetLexem();
+  if (operand.get_type() == LexemType::STRING) {
+    return ValueType::String;
+  }
+  return ValueType::Unknown;
 }
 
 /**
- * @brief Analyzes a 'while' loop construct in the source code.
+ * @brief Analyzes the syntax and semantics of a print statement.
  * 
- * This function processes a 'while' loop by performing the following steps:
- * 1. Retrieves the next lexeme.
- * 2. Analyzes the loop's expression.
- * 3. Checks for the presence of a colon (':') after the expression.
- * 4. Ensures that the block following the 'while' loop is indented.
- * 5. Enters a new scope for the loop's body.
- * 6. Analyzes each statement within the loop's body until the end of the block.
- * 7. Exits the scope after processing the loop's body.
+ * This function processes a print statement by verifying the type of its
+ * argument, which must be an expression starting with an identifier,
+ * number, or string.
  * 
- * @throws std::runtime_error If the expected ':' is not found after the 'while' expression.
- * @throws std::runtime_error If the expected indented block is not found after the 'while' statement.
+ * @throws std::runtime_error if an invalid argument type is encountered.
  */
-void SemanticAnalyzer::AnalyzeWhile() {
-  GetLexem();
-  AnalyzeExpression();
-  GetLexem();
-  if (curLex_.get_text() != ":") {
+void SemanticAnalyzer::AnalyzePrint(PrintNode& node) {
+  const Span<Lexem>& value = node.value->tokens;
+  if (!value.empty() && value.front().get_type() != LexemType::IDENTIFIER &&
+      value.front().get_type() != LexemType::NUMBER &&
+      value.front().get_type() != LexemType::STRING) {
     throw std::runtime_error(
-        "Expected ':' after while expression \n On line: " +
-        std::to_string(curLex_.get_line()));
+        "Invalid argument for print: " +
+        std::string(value.front().get_text()) +
+        "\nOn line: " + std::to_string(value.front().get_line()));
   }
-  GetLexem();
-  GetLexem();
-  if (curLex_.get_type() != "INDENT") {
-    throw std::runtime_error("Expected indented block after while \nOn line: " +
-                             std::to_string(curLex_.get_line()));
-  }
-  EnterScope();
-  GetLexem();
-  while (curLex_.get_type() != "DEDENT" && curLex_.get_type() != "EOC") {
-    AnalyzeStatement();
-  }
-  if (curLex_.get_type() == "DEDENT") {
-    GetLexem();
-  }
-  ExitScope();
+  AnalyzeExpression(*node.value);
 }
 
 /**
- * @brief Analyzes an 'if' statement in the source code.
+ * @brief Analyzes a 'while' loop construct in the source code.
  * 
- * This function processes the syntax and semantics of an 'if' statement,
- * ensuring that it follows the correct structure and rules. It handles
- * the conditional expression, the indented block of code that follows,
- * and optionally an 'else' block if present.
+ * This function processes a 'while' loop by performing the following steps:
+ * 1. Analyzes the loop's expression.
+ * 2. Enters a new scope for the loop's body.
+ * 3. Analyzes each statement within the loop's body.
+ * 4. Exits the scope after processing the loop's body.
+ */
+void SemanticAnalyzer::AnalyzeWhile(WhileNode& node) {
+  AnalyzeExpression(*node.condition);
+  scopes_.EnterScope();
+  AnalyzeBlock(node.body);
+  scopes_.ExitScope();
+}
+
+/**
+ * @brief Analyzes an 'if' statement in the source code.
  * 
- * @throws std::runtime_error If the syntax of the 'if' statement is incorrect,
- * such as missing ':' after the condition or 'else', or missing indented blocks.
+ * This function processes the semantics of an 'if' statement. It handles
+ * the conditional expression, the block of code that follows, and
+ * optionally an 'else' block if present; each block gets its own scope.
  */
-void SemanticAnalyzer::AnalyzeIf() {
-  GetLexem();
-  AnalyzeExpression();
-  GetLexem();
-  if (curLex_.get_text() != ":") {
-    throw std::runtime_error("Expected ':' after if expression \n On line: " +
-                             std::to_string(curLex_.get_line()));
-  }
-  GetLexem();
-  GetLexem();
-  if (curLex_.get_type() != "INDENT") {
-    throw std::runtime_error("Expected indented block after if \nOn line: " +
-                             std::to_string(curLex_.get_line()));
-  }
-  EnterScope();
-  GetLexem();
-  while (curLex_.get_type() != "DEDENT" && curLex_.get_type() != "EOC") {
-    AnalyzeStatement();
-  }
-  if (curLex_.get_type() == "DEDENT") {
-    GetLexem();
-  }
-  ExitScope();
-  while (curLex_.get_type() == "NEWLINE") {
-    GetLexem();
-  }
-  if (curLex_.get_text() == "else") {
-    GetLexem();
-    if (curLex_.get_text() != ":") {
-      throw std::runtime_error("Expected ':' after else \n On line: " +
-                               std::to_string(curLex_.get_line()));
-    }
-    GetLexem();
-    GetLexem();
-    if (curLex_.get_type() != "INDENT") {
-      throw std::runtime_error(
-          "Expected indented block after else \nOn line: " +
-          std::to_string(curLex_.get_line()));
-    }
-    EnterScope();
-    GetLexem();
-    while (curLex_.get_type() != "DEDENT" && curLex_.get_type() != "EOC") {
-      AnalyzeStatement();
-    }
-    if (curLex_.get_type() == "DEDENT") {
-      GetLexem();
-    }
-    ExitScope();
+void SemanticAnalyzer::AnalyzeIf(IfNode& node) {
+  AnalyzeExpression(*node.condition);
+  scopes_.EnterScope();
+  AnalyzeBlock(node.then);
+  scopes_.ExitScope();
+  if (node.hasElse) {
+    scopes_.EnterScope();
+    AnalyzeBlock(node.otherwise);
+    scopes_.ExitScope();
   }
 }
 
 /**
  * @brief Analyzes a 'for' loop in the source code.
  * 
- * This function processes the syntax and semantics of a 'for' loop, ensuring
- * that it follows the expected structure and semantics. The expected structure
- * is:
+ * This function processes the semantics of a 'for' loop of the form
  * 
  * for <identifier> in range(<expression>):
  *     <indented block>
  * 
- * The function performs the following checks:
- * - The loop variable is a valid identifier.
- * - The keyword 'in' follows the variable name.
- * - The keyword 'range' follows 'in'.
- * - The range expression is enclosed in parentheses.
- * - A colon (:) follows the range expression.
- * - An indented block follows the colon.
+ * The structure is checked by SyntaxAnalyzer; this function analyzes the
+ * range expression and manages the scope of the loop variable, an int
+ * added when the loop starts and removed when the loop ends.
  * 
- * If any of these checks fail, a runtime error is thrown with a descriptive
- * message indicating the nature of the error and the line number where it
- * occurred.
- * 
- * The function also manages the scope of the loop variable, adding it to the
- * current scope and removing it when the loop ends.
- * 
- * @throws std::runtime_error if the 'for' loop does not follow the expected
- *         structure or semantics.
+ * @throws std::runtime_error if the range expression or the body is
+ *         invalid.
  */
-void SemanticAnalyzer::AnalyzeFor() {
-  GetLexem();
-  if (curLex_.get_type() != "IDENTIFIER") {
-    throw std::runtime_error(
-        "Invalid variable name: " + curLex_.get_text() +
-        "\nOn line: " + std::to_string(curLex_.get_line()));
-  }
-  std::string varName = curLex_.get_text();
-
-  GetLexem();
-  if (curLex_.get_text() != "in") {
-    throw std::runtime_error(
-        "Expected 'in' after variable name, got: " + curLex_.get_text() +
-        "\nOn line: " + std::to_string(curLex_.get_line()));
-  }
-  GetLexem();
-  if (curLex_.get_text() != "range") {
-    throw std::runtime_error(
-        "Expected 'range', got: " + curLex_.get_text() +
-        "\nOn line: " + std::to_string(curLex_.get_line()));
-  }
-  GetLexem();
-  if (curLex_.get_text() != "(") {
-    throw std::runtime_error(
-        "Expected '(' after range, got: " + curLex_.get_text() +
-        "\nOn line: " + std::to_string(curLex_.get_line()));
-  }
-  GetLexem();
-  AnalyzeExpression();
-  if (curLex_.get_text() != ")") {
-    throw std::runtime_error(
-        "Expected ')' after range value, got: " + curLex_.get_text() +
-        "\nOn line: " + std::to_string(curLex_.get_line()));
-  }
-  GetLexem();
-  if (curLex_.get_text() != ":") {
-    throw std::runtime_error("Expected ':' after range expression \nOn line: " +
-                             std::to_string(curLex_.get_line()));
-  }
-  GetLexem();
-  GetLexem();
-  if (curLex_.get_type() != "INDENT") {
-    throw std::runtime_error(
-        "Expected indented block after for loop \nOn line: " +
-        std::to_string(curLex_.get_line()));
-  }
-  EnterScope();
-  AddVariable(varName, "int");
-
-  GetLexem();
-  while (curLex_.get_type() != "DEDENT" && curLex_.get_type() != "EOC") {
-    AnalyzeStatement();
-  }
-  if (curLex_.get_type() == "DEDENT") {
-    GetLexem();
-  }
-  ExitScope();
-}
\ No newline at end of file
+void SemanticAnalyzer::AnalyzeFor(ForNode& node) {
+  AnalyzeExpression(*node.bound);
+  scopes_.EnterScope();
+  AddVariable(node.variable, ValueType::Int);
+  AnalyzeBlock(node.body);
+  scopes_.ExitScope();
+}
@@ -0,0 +1,251 @@
+#include "Server.h"
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string_view>
+
+#if SIGMA_HAS_SERVE
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+#if SIGMA_HAS_SERVE
+
+const size_t kMaxHeaderBytes = 64;
+const size_t kMaxProgramBytes = 64 << 20;
+const int kBacklog = 16;
+const int kMalformedRequest = 2;
+
+/**
+ * @brief Buffered reads and writes on a pair of file descriptors
+ */
+class Channel {
+ public:
+  Channel(int in, int out) : in_(in), out_(out) {}
+
+  /**
+   * @brief Reads up to the next newline, which is dropped.
+   *
+   * @return false at the end of the input, or if no newline comes within
+   *         limit bytes
+   */
+  bool ReadLine(std::string& line, size_t limit) {
+    size_t newline;
+    while ((newline = buffer_.find('\n')) == std::string::npos) {
+      if (buffer_.size() > limit || !Fill()) {
+        return false;
+      }
+    }
+    line = buffer_.substr(0, newline);
+    buffer_.erase(0, newline + 1);
+    return true;
+  }
+
+  /**
+   * @brief Reads exactly size bytes.
+   *
+   * @return false if the input ends first
+   */
+  bool Read(size_t size, std::string& data) {
+    while (buffer_.size() < size) {
+      if (!Fill()) {
+        return false;
+      }
+    }
+    data = buffer_.substr(0, size);
+    buffer_.erase(0, size);
+    return true;
+  }
+
+  /**
+   * @brief Writes all of data.
+   *
+   * @return false if the peer went away
+   */
+  bool Write(std::string_view data) {
+    while (!data.empty()) {
+      ssize_t written = write(out_, data.data(), data.size());
+      if (written < 0 && errno == EINTR) {
+        continue;
+      }
+      if (written <= 0) {
+        return false;
+      }
+      data.remove_prefix(written);
+    }
+    return true;
+  }
+
+ private:
+  int in_;
+  int out_;
+  std::string buffer_;
+
+  bool Fill() {
+    char chunk[1 << 16];
+    ssize_t count;
+    do {
+      count = read(in_, chunk, sizeof(chunk));
+    } while (count < 0 && errno == EINTR);
+    if (count <= 0) {
+      return false;
+    }
+    buffer_.append(chunk, count);
+    return true;
+  }
+};
+
+std::string Response(int status, const std::string& out,
+                     const std::string& err) {
+  return "DONE " + std::to_string(status) + " " + std::to_string(out.size()) +
+         " " + std::to_string(err.size()) + "\n" + out + err;
+}
+
+/**
+ * @brief Parses a "RUN <bytes>" header.
+ *
+ * @return false if the header is malformed or the body too large
+ */
+bool ParseHeader(const std::string& header, size_t& size) {
+  std::istringstream in(header);
+  std::string command;
+  std::string extra;
+  if (!(in >> command >> size) || command != "RUN" || (in >> extra)) {
+    return false;
+  }
+  return size <= kMaxProgramBytes;
+}
+
+/**
+ * @brief Runs a program with std::cout and std::cerr redirected to
+ * strings.
+ */
+int RunCaptured(std::string_view code, const RunOptions& options,
+                std::string& out, std::string& err) {
+  std::ostringstream captured;
+  std::ostringstream diagnostics;
+  std::streambuf* stdoutBuffer = std::cout.rdbuf(captured.rdbuf());
+  std::streambuf* stderrBuffer = std::cerr.rdbuf(diagnostics.rdbuf());
+  int status = RunProgram(code, options);
+  std::cout.rdbuf(stdoutBuffer);
+  std::cerr.rdbuf(stderrBuffer);
+  out = captured.str();
+  err = diagnostics.str();
+  return status;
+}
+
+/**
+ * @brief Answers the requests of one session until its input ends.
+ */
+void ServeSession(Channel& channel, const RunOptions& options) {
+  std::string header;
+  std::string code;
+  std::string out;
+  std::string err;
+  while (channel.ReadLine(header, kMaxHeaderBytes)) {
+    size_t size;
+    if (!ParseHeader(header, size)) {
+      channel.Write(Response(kMalformedRequest, "",
+                             "Malformed request: expected RUN <bytes>\n"));
+      return;
+    }
+    if (!channel.Read(size, code)) {
+      return;
+    }
+    int status = RunCaptured(code, options, out, err);
+    if (!channel.Write(Response(status, out, err))) {
+      return;
+    }
+  }
+}
+
+/**
+ * @brief Binds a listening Unix domain socket, replacing a stale socket
+ * left at the path by an earlier server.
+ *
+ * @throws std::runtime_error if the path is too long, taken by another
+ *         kind of file, or the socket cannot be bound
+ */
+int Listen(const std::string& path) {
+  sockaddr_un address{};
+  address.sun_family = AF_UNIX;
+  if (path.size() >= sizeof(address.sun_path)) {
+    throw std::runtime_error("Socket path too long: " + path);
+  }
+  std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+
+  struct stat existing;
+  if (lstat(path.c_str(), &existing) == 0) {
+    if (!S_ISSOCK(existing.st_mode)) {
+      throw std::runtime_error("Not a socket: " + path);
+    }
+    unlink(path.c_str());
+  }
+
+  int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd < 0) {
+    throw std::runtime_error(std::string("Failed to create socket: ") +
+                             std::strerror(errno));
+  }
+  if (bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+      listen(fd, kBacklog) != 0) {
+    int error = errno;
+    close(fd);
+    throw std::runtime_error("Failed to listen on '" + path +
+                             "': " + std::strerror(error));
+  }
+  return fd;
+}
+
+#endif  // SIGMA_HAS_SERVE
+
+}  // namespace
+
+/**
+ * @brief Serves requests until standard input ends, or forever on a
+ * socket.
+ *
+ * @param options Options every program is compiled and run with
+ * @param socketPath Unix domain socket to listen on; empty to read
+ *        requests from standard input and answer on standard output
+ * @return int 0 once standard input ends
+ * @throws std::runtime_error if the socket cannot be set up
+ */
+int Serve(const RunOptions& options, const std::string& socketPath) {
+#if SIGMA_HAS_SERVE
+  // A client that hangs up must not take the server down with it.
+  signal(SIGPIPE, SIG_IGN);
+  if (socketPath.empty()) {
+    Channel channel(STDIN_FILENO, STDOUT_FILENO);
+    ServeSession(channel, options);
+    return 0;
+  }
+  int listener = Listen(socketPath);
+  while (true) {
+    int connection = accept(listener, nullptr, nullptr);
+    if (connection < 0) {
+      if (errno == EINTR || errno == ECONNABORTED) {
+        continue;
+      }
+      int error = errno;
+      close(listener);
+      throw std::runtime_error(std::string("Failed to accept: ") +
+                               std::strerror(error));
+    }
+    Channel channel(connection, connection);
+    ServeSession(channel, options);
+    close(connection);
+  }
+#else
+  (void)options;
+  (void)socketPath;
+  throw std::runtime_error("--serve is not supported on this platform");
+#endif
+}
@@ -0,0 +1,112 @@
+#include "SourceBuffer.h"
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#if SIGMA_HAS_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#endif
+
+#if SIGMA_HAS_MMAP
+namespace {
+
+std::runtime_error ReadError(const std::string& path) {
+  return std::runtime_error("Failed to read code file '" + path +
+                            "': " + std::strerror(errno));
+}
+
+}  // namespace
+#endif
+
+/**
+ * @brief Maps or reads the source at the given path.
+ *
+ * @param path Path of the code file, "-" for standard input
+ * @throws std::runtime_error if the source cannot be opened or read
+ */
+SourceBuffer::SourceBuffer(const std::string& path) {
+#if SIGMA_HAS_MMAP
+  if (path == "-") {
+    ReadAll(STDIN_FILENO, path);
+    return;
+  }
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    throw std::runtime_error("Failed to open code file '" + path + "'");
+  }
+  struct stat info;
+  if (fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0) {
+    void* mapping = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mapping != MAP_FAILED) {
+      madvise(mapping, info.st_size, MADV_SEQUENTIAL);
+      data_ = static_cast<const char*>(mapping);
+      size_ = info.st_size;
+      mapped_ = true;
+      close(fd);
+      return;
+    }
+  }
+  try {
+    ReadAll(fd, path);
+  } catch (...) {
+    close(fd);
+    throw;
+  }
+  close(fd);
+#else
+  if (path == "-") {
+    contents_.assign(std::istreambuf_iterator<char>(std::cin),
+                     std::istreambuf_iterator<char>());
+  } else {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+      throw std::runtime_error("Failed to open code file '" + path + "'");
+    }
+    contents_.assign(std::istreambuf_iterator<char>(file),
+                     std::istreambuf_iterator<char>());
+  }
+  data_ = contents_.data();
+  size_ = contents_.size();
+#endif
+}
+
+SourceBuffer::~SourceBuffer() {
+#if SIGMA_HAS_MMAP
+  if (mapped_) {
+    munmap(const_cast<char*>(data_), size_);
+  }
+#endif
+}
+
+/**
+ * @brief Reads a descriptor that cannot be mapped until end of file.
+ *
+ * @throws std::runtime_error if a read fails
+ */
+void SourceBuffer::ReadAll(int fd, const std::string& path) {
+#if SIGMA_HAS_MMAP
+  char chunk[1 << 16];
+  while (true) {
+    ssize_t count = read(fd, chunk, sizeof(chunk));
+    if (count == 0) {
+      break;
+    }
+    if (count < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      throw ReadError(path);
+    }
+    contents_.append(chunk, count);
+  }
+  data_ = contents_.data();
+  size_ = contents_.size();
+#endif
+}
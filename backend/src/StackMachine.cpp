@@ -0,0 +1,484 @@
+#include "StackMachine.h"
+#include <iostream>
+#include <stdexcept>
+
+/**
+ * @brief Constructs a StackMachine for a compiled program.
+ *
+ * @param program Program produced by BytecodeCompiler::Compile(); it must
+ *        outlive the machine
+ */
+StackMachine::StackMachine(const Program& program)
+    : program_(program),
+      callCounts_(program.functions.size(), 0),
+      native_(program.functions.size()),
+      jitRejected_(program.functions.size(), false),
+      inlineCaches_(program.callSites.size()) {}
+
+/**
+ * @brief Sets how many calls make a function hot enough to be compiled.
+ *
+ * @param threshold Number of calls, 0 disables the JIT
+ */
+void StackMachine::SetJitThreshold(uint32_t threshold) {
+  jitThreshold_ = threshold;
+  ++functionTableEpoch_;
+}
+
+/**
+ * @brief Executes the program with the dispatch strategy selected at build
+ * time.
+ */
+void StackMachine::Run() {
+  Run(SIGMA_THREADED_DISPATCH ? Dispatch::Threaded : Dispatch::Switch);
+}
+
+/**
+ * @brief Executes the program from the first instruction until it falls
+ * off the end. Each call starts from a fresh machine state.
+ *
+ * @param dispatch Dispatch strategy of the interpreter loop
+ */
+void StackMachine::Run(Dispatch dispatch) {
+  Reset();
+  if (dispatch == Dispatch::Threaded) {
+    RunThreaded();
+  } else {
+    RunSwitch();
+  }
+  std::cout.flush();
+}
+
+/**
+ * @brief Drops everything left from a previous run.
+ */
+void StackMachine::Reset() {
+  stack_.clear();
+  globals_.assign(program_.globalNames.size(), std::nullopt);
+  locals_.clear();
+  frames_.clear();
+  pc_ = 0;
+}
+
+/**
+ * @brief Interpreter loop with a central switch over the opcode.
+ */
+void StackMachine::RunSwitch() {
+  const std::vector<Instruction>& code = program_.code;
+  while (pc_ < code.size()) {
+    Instruction instruction = code[pc_++];
+    switch (instruction.op) {
+      case OpCode::PushConst:
+        PushConst(instruction.arg);
+        break;
+      case OpCode::LoadGlobal:
+        LoadGlobal(instruction.arg);
+        break;
+      case OpCode::StoreGlobal:
+        StoreGlobal(instruction.arg);
+        break;
+      case OpCode::LoadLocal:
+        LoadLocal(instruction.arg);
+        break;
+      case OpCode::StoreLocal:
+        StoreLocal(instruction.arg);
+        break;
+      case OpCode::Add:
+        Binary(Operator::Add);
+        break;
+      case OpCode::Sub:
+        Binary(Operator::Sub);
+        break;
+      case OpCode::Mul:
+        Binary(Operator::Mul);
+        break;
+      case OpCode::Div:
+        Binary(Operator::Div);
+        break;
+      case OpCode::Mod:
+        Binary(Operator::Mod);
+        break;
+      case OpCode::Less:
+        Binary(Operator::Less);
+        break;
+      case OpCode::Greater:
+        Binary(Operator::Greater);
+        break;
+      case OpCode::LessEqual:
+        Binary(Operator::LessEqual);
+        break;
+      case OpCode::GreaterEqual:
+        Binary(Operator::GreaterEqual);
+        break;
+      case OpCode::Equal:
+        Binary(Operator::Equal);
+        break;
+      case OpCode::NotEqual:
+        Binary(Operator::NotEqual);
+        break;
+      case OpCode::And:
+        Binary(Operator::And);
+        break;
+      case OpCode::Or:
+        Binary(Operator::Or);
+        break;
+      case OpCode::Not:
+        Unary(Operator::Not);
+        break;
+      case OpCode::Negate:
+        Unary(Operator::Negate);
+        break;
+      case OpCode::Jump:
+        pc_ = instruction.arg;
+        break;
+      case OpCode::JumpIfFalse:
+        JumpIfFalse(instruction.arg);
+        break;
+      case OpCode::Call:
+        Call(instruction.arg);
+        break;
+      case OpCode::Return:
+        Return();
+        break;
+      case OpCode::Leave:
+        Leave();
+        break;
+      case OpCode::Print:
+        Print();
+        break;
+    }
+  }
+}
+
+/**
+ * @brief Interpreter loop using direct-threaded code.
+ *
+ * The program is first translated into one (handler address, operand)
+ * pair per instruction plus a halt entry past the end. Every handler ends
+ * by jumping to the handler of the next pair, so there is no central
+ * dispatch branch shared by all opcodes.
+ */
+void StackMachine::RunThreaded() {
+#if SIGMA_HAS_COMPUTED_GOTO
+  struct Threaded {
+    const void* handler;
+    uint32_t arg;
+  };
+
+  // Indexed by OpCode, keep in the order of the enum.
+  static const void* const kHandlers[] = {
+      &&op_push_const, &&op_load_global, &&op_store_global, &&op_load_local,
+      &&op_store_local, &&op_add, &&op_sub, &&op_mul, &&op_div, &&op_mod,
+      &&op_less, &&op_greater, &&op_less_equal, &&op_greater_equal,
+      &&op_equal, &&op_not_equal, &&op_and, &&op_or, &&op_not, &&op_negate,
+      &&op_jump, &&op_jump_if_false, &&op_call, &&op_return, &&op_leave,
+      &&op_print};
+
+  const std::vector<Instruction>& code = program_.code;
+  std::vector<Threaded> threaded(code.size() + 1);
+  for (size_t i = 0; i < code.size(); ++i) {
+    threaded[i] = {kHandlers[static_cast<size_t>(code[i].op)], code[i].arg};
+  }
+  threaded[code.size()] = {&&op_halt, 0};
+
+  uint32_t arg;
+#define SIGMA_DISPATCH()           \
+  do {                             \
+    arg = threaded[pc_].arg;       \
+    goto* threaded[pc_++].handler; \
+  } while (0)
+
+  SIGMA_DISPATCH();
+op_push_const:
+  PushConst(arg);
+  SIGMA_DISPATCH();
+op_load_global:
+  LoadGlobal(arg);
+  SIGMA_DISPATCH();
+op_store_global:
+  StoreGlobal(arg);
+  SIGMA_DISPATCH();
+op_load_local:
+  LoadLocal(arg);
+  SIGMA_DISPATCH();
+op_store_local:
+  StoreLocal(arg);
+  SIGMA_DISPATCH();
+op_add:
+  Binary(Operator::Add);
+  SIGMA_DISPATCH();
+op_sub:
+  Binary(Operator::Sub);
+  SIGMA_DISPATCH();
+op_mul:
+  Binary(Operator::Mul);
+  SIGMA_DISPATCH();
+op_div:
+  Binary(Operator::Div);
+  SIGMA_DISPATCH();
+op_mod:
+  Binary(Operator::Mod);
+  SIGMA_DISPATCH();
+op_less:
+  Binary(Operator::Less);
+  SIGMA_DISPATCH();
+op_greater:
+  Binary(Operator::Greater);
+  SIGMA_DISPATCH();
+op_less_equal:
+  Binary(Operator::LessEqual);
+  SIGMA_DISPATCH();
+op_greater_equal:
+  Binary(Operator::GreaterEqual);
+  SIGMA_DISPATCH();
+op_equal:
+  Binary(Operator::Equal);
+  SIGMA_DISPATCH();
+op_not_equal:
+  Binary(Operator::NotEqual);
+  SIGMA_DISPATCH();
+op_and:
+  Binary(Operator::And);
+  SIGMA_DISPATCH();
+op_or:
+  Binary(Operator::Or);
+  SIGMA_DISPATCH();
+op_not:
+  Unary(Operator::Not);
+  SIGMA_DISPATCH();
+op_negate:
+  Unary(Operator::Negate);
+  SIGMA_DISPATCH();
+op_jump:
+  pc_ = arg;
+  SIGMA_DISPATCH();
+op_jump_if_false:
+  JumpIfFalse(arg);
+  SIGMA_DISPATCH();
+op_call:
+  Call(arg);
+  SIGMA_DISPATCH();
+op_return:
+  Return();
+  SIGMA_DISPATCH();
+op_leave:
+  Leave();
+  SIGMA_DISPATCH();
+op_print:
+  Print();
+  SIGMA_DISPATCH();
+op_halt:
+  return;
+#undef SIGMA_DISPATCH
+#else
+  RunSwitch();
+#endif
+}
+
+void StackMachine::PushConst(uint32_t constant) {
+  stack_.push_back(program_.constants[constant]);
+}
+
+/**
+ * @brief Pushes a global.
+ *
+ * @throws std::runtime_error if the global was never assigned
+ */
+void StackMachine::LoadGlobal(uint32_t slot) {
+  const auto& value = globals_[slot];
+  if (!value) {
+    throw std::runtime_error("Undefined variable: " +
+                             program_.globalNames[slot]);
+  }
+  stack_.push_back(*value);
+}
+
+void StackMachine::StoreGlobal(uint32_t slot) {
+  globals_[slot] = Pop();
+}
+
+/**
+ * @brief Pushes a slot of the current frame.
+ *
+ * @throws std::runtime_error if the slot was never assigned
+ */
+void StackMachine::LoadLocal(uint32_t slot) {
+  const Frame& frame = frames_.back();
+  const auto& value = locals_[frame.localsBase + slot];
+  if (!value) {
+    throw std::runtime_error(
+        "Undefined variable: " +
+        program_.functions[frame.function].localNames[slot]);
+  }
+  stack_.push_back(*value);
+}
+
+void StackMachine::StoreLocal(uint32_t slot) {
+  locals_[frames_.back().localsBase + slot] = Pop();
+}
+
+void StackMachine::JumpIfFalse(uint32_t target) {
+  if (!Pop().IsTruthy()) {
+    pc_ = target;
+  }
+}
+
+/**
+ * @brief Enters a user function: reserves its frame, binds the arguments
+ * on the operand stack to its first slots and jumps to its entry.
+ *
+ * The callee comes from the inline cache of the call site; the function
+ * table is only consulted when the cache is stale.
+ *
+ * @param site Index into Program::callSites
+ * @throws std::runtime_error if arguments are missing
+ */
+void StackMachine::Call(uint32_t site) {
+  InlineCache& cache = inlineCaches_[site];
+  if (cache.epoch != functionTableEpoch_) {
+    ResolveCallSite(site);
+  }
+  if (stack_.size() < cache.arity) {
+    throw std::runtime_error("Not enough arguments for function: " +
+                             program_.functions[cache.function].name);
+  }
+  if (cache.countCalls &&
+      ++callCounts_[cache.function] >= jitThreshold_) {
+    CompileFunction(cache.function);
+    ResolveCallSite(site);
+  }
+  if (cache.native && CallNative(*cache.native, cache.arity)) {
+    return;
+  }
+
+  Frame frame;
+  frame.returnAddress = pc_;
+  frame.localsBase = locals_.size();
+  frame.function = cache.function;
+  locals_.resize(locals_.size() + cache.frameSize);
+  for (uint32_t i = cache.arity; i-- > 0;) {
+    locals_[frame.localsBase + i] = Pop();
+  }
+  frame.stackBase = stack_.size();
+  frames_.push_back(frame);
+  pc_ = cache.entry;
+}
+
+/**
+ * @brief Fills the inline cache of a call site from the function table.
+ */
+void StackMachine::ResolveCallSite(uint32_t site) {
+  InlineCache& cache = inlineCaches_[site];
+  uint32_t function = program_.callSites[site].function;
+  const FunctionInfo& info = program_.functions[function];
+  cache.epoch = functionTableEpoch_;
+  cache.function = function;
+  cache.entry = info.entry;
+  cache.arity = info.arity;
+  cache.frameSize = info.frameSize;
+  cache.native = native_[function].get();
+  cache.countCalls =
+      jitThreshold_ != 0 && !cache.native && !jitRejected_[function];
+}
+
+/**
+ * @brief Hands a hot function to the JIT. Either outcome changes the
+ * function table, so every inline cache goes stale.
+ */
+void StackMachine::CompileFunction(uint32_t function) {
+  native_[function] = JitCompiler(program_, function).Compile();
+  jitRejected_[function] = !native_[function];
+  ++functionTableEpoch_;
+}
+
+/**
+ * @brief Runs a call with the compiled code of the callee.
+ *
+ * Integer arguments and globals are copied into a slot array, the native
+ * code runs on it and the globals are written back, so the effect is the
+ * same as interpreting the body.
+ *
+ * @param native Compiled code of the callee
+ * @param arity Number of arguments on the operand stack
+ * @return true if the call was executed, false if it must be interpreted
+ */
+bool StackMachine::CallNative(const NativeFunction& native, uint32_t arity) {
+  const std::vector<uint32_t>& globals = native.Globals();
+  nativeSlots_.assign(native.FrameSize() + globals.size(), 0);
+  for (uint32_t i = 0; i < arity; ++i) {
+    const Value& argument = stack_[stack_.size() - arity + i];
+    if (!argument.IsInt()) {
+      return false;
+    }
+    nativeSlots_[i] = argument.AsInt();
+  }
+  for (size_t i = 0; i < globals.size(); ++i) {
+    const auto& value = globals_[globals[i]];
+    if (!value || !value->IsInt()) {
+      return false;
+    }
+    nativeSlots_[native.FrameSize() + i] = value->AsInt();
+  }
+
+  native.Invoke(nativeSlots_.data());
+  stack_.resize(stack_.size() - arity);
+  for (size_t i = 0; i < globals.size(); ++i) {
+    globals_[globals[i]] =
+        Value(static_cast<long long>(nativeSlots_[native.FrameSize() + i]));
+  }
+  return true;
+}
+
+/**
+ * @brief Pops the return value and leaves the function.
+ */
+void StackMachine::Return() {
+  Pop();
+  Leave();
+}
+
+/**
+ * @brief Leaves the current function and resumes after its call site.
+ */
+void StackMachine::Leave() {
+  const Frame& frame = frames_.back();
+  pc_ = frame.returnAddress;
+  stack_.resize(frame.stackBase);
+  locals_.resize(frame.localsBase);
+  frames_.pop_back();
+}
+
+void StackMachine::Print() {
+  std::cout << (stack_.empty() ? "" : Pop().ToString()) << '\n';
+}
+
+/**
+ * @brief Pops two operands and pushes the result of a binary operator.
+ */
+void StackMachine::Binary(Operator op) {
+  Value rhs = Pop();
+  Value lhs = Pop();
+  stack_.push_back(Value::Apply(op, lhs, rhs));
+}
+
+/**
+ * @brief Replaces the top of the stack with the result of a unary
+ * operator.
+ */
+void StackMachine::Unary(Operator op) {
+  stack_.push_back(Value::Apply(op, Pop()));
+}
+
+/**
+ * @brief Pops a value from the operand stack.
+ *
+ * @throws std::runtime_error if the stack is empty
+ */
+Value StackMachine::Pop() {
+  if (stack_.empty()) {
+    throw std::runtime_error("Operand stack underflow");
+  }
+  Value top = std::move(stack_.back());
+  stack_.pop_back();
+  return top;
+}
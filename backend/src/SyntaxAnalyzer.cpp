@@ -2,17 +2,29 @@
 #include <stdexcept>
 #include <string>
 
+/**
+ * @brief Allocates a statement node in the arena of the tree, at the line
+ * of the current lexeme.
+ */
+template <typename Node>
+Node* SyntaxAnalyzer::NewNode() {
+  Node* node = ast_.arena.New<Node>();
+  node->line = curLex_.get_line();
+  return node;
+}
+
 /**
  * @brief Advances to the next lexeme in the token stream
  * 
- * Retrieves the next lexeme from the lexical analysis results if available.
- * Updates the current lexeme (curLex_) by incrementing the index counter.
- * Does nothing if all lexemes have been processed (index >= lex.size()).
+ * Pulls the next lexeme from the lexical analyzer, which lexes it on demand.
+ * Does nothing once the end-of-code (EOC) lexeme was reached.
  */
 void SyntaxAnalyzer::GetLexem() {
-  if (index < lex.size()) {
-    curLex_ = lex[index++];
+  if (atEnd_) {
+    return;
   }
+  curLex_ = lexer_.Next();
+  atEnd_ = curLex_.get_type() == LexemType::EOC;
 }
 
 /**
@@ -21,6 +33,7 @@ void SyntaxAnalyzer::GetLexem() {
  * This function starts the syntax analysis by fetching the first lexeme
  * and then analyzing the program structure according to the grammar rules.
  * It serves as the entry point for the entire syntax analysis process.
+ * The tree of the program is left in GetAst().
  */
 void SyntaxAnalyzer::Analyze() {
   GetLexem();
@@ -32,14 +45,41 @@ void SyntaxAnalyzer::Analyze() {
  * 
  * This method iteratively processes statements in the program by calling AnalyzeStatement()
  * for each statement until it encounters the end of code (EOC) token. It serves as the
- * main entry point for syntax analysis of the entire program.
+ * main entry point for syntax analysis of the entire program. The statements
+ * become the top-level block of the tree.
  * 
  * @throws May throw syntax analysis related exceptions if invalid syntax is encountered
  */
 void SyntaxAnalyzer::AnalyzeProgram() {
-  while (curLex_.get_type() != "EOC") {
-    AnalyzeStatement();
+  std::vector<Statement*> statements;
+  while (curLex_.get_type() != LexemType::EOC) {
+    if (Statement* statement = AnalyzeStatement()) {
+      statements.push_back(statement);
+    }
   }
+  ast_.program = Block::Copy(ast_.arena, statements);
+}
+
+/**
+ * @brief Analyzes the statements of an indented block up to its DEDENT.
+ *
+ * Expects the INDENT that opens the block to be consumed already and
+ * consumes the DEDENT that closes it.
+ *
+ * @return Block The statements of the block
+ */
+Block SyntaxAnalyzer::AnalyzeBlock() {
+  std::vector<Statement*> statements;
+  while (curLex_.get_type() != LexemType::DEDENT &&
+         curLex_.get_type() != LexemType::EOC) {
+    if (Statement* statement = AnalyzeStatement()) {
+      statements.push_back(statement);
+    }
+  }
+  if (curLex_.get_type() == LexemType::DEDENT) {
+    GetLexem();
+  }
+  return Block::Copy(ast_.arena, statements);
 }
 
 /**
@@ -55,43 +95,51 @@ void SyntaxAnalyzer::AnalyzeProgram() {
  * - Variable declarations
  * - Break and continue statements
  * 
+ * An 'else' is only valid right after the block of an 'if' and is analyzed
+ * there.
+ * 
+ * @return Statement* The node of the statement, nullptr for a blank line or
+ *         an indentation change
  * @throws std::runtime_error If an unexpected keyword is encountered
  */
-void SyntaxAnalyzer::AnalyzeStatement() {
-  if (curLex_.get_type() == "NEWLINE" || curLex_.get_type() == "INDENT" ||
-      curLex_.get_type() == "DEDENT") {
+Statement* SyntaxAnalyzer::AnalyzeStatement() {
+  if (curLex_.get_type() == LexemType::NEWLINE ||
+      curLex_.get_type() == LexemType::INDENT ||
+      curLex_.get_type() == LexemType::DEDENT) {
     GetLexem();
-    return;
-  }
-
-  if (curLex_.get_type() != "KEYWORD") {
-    AnalyzeAssignment();
-    return;
-  }
-
-  std::string keyword = curLex_.get_text();
-  if (keyword == "def") {
-    AnalyzeFunctionDeclaration();
-  } else if (keyword == "if") {
-    AnalyzeIfStatement();
-  } else if (keyword == "while") {
-    AnalyzeWhileStatement();
-  } else if (keyword == "for") {
-    AnalyzeForStatement();
-  } else if (keyword == "print") {
-    AnalyzePrintStatement();
-  } else if (keyword == "return") {
-    AnalyzeReturnStatement();
-  } else if (keyword == "else") {
-    AnalyzeElseStatement();
+    return nullptr;
+  }
+
+  if (curLex_.get_type() != LexemType::KEYWORD) {
+    return AnalyzeAssignment();
+  }
+
+  Keyword keyword = curLex_.get_keyword();
+  if (keyword == Keyword::Def) {
+    return AnalyzeFunctionDeclaration();
+  } else if (keyword == Keyword::If) {
+    return AnalyzeIfStatement();
+  } else if (keyword == Keyword::While) {
+    return AnalyzeWhileStatement();
+  } else if (keyword == Keyword::For) {
+    return AnalyzeForStatement();
+  } else if (keyword == Keyword::Print) {
+    return AnalyzePrintStatement();
+  } else if (keyword == Keyword::Return) {
+    return AnalyzeReturnStatement();
   } else if (IsType(keyword)) {
-    AnalyzeVariableDeclaration();
-  } else if (keyword == "break" || keyword == "continue") {
+    return AnalyzeVariableDeclaration();
+  } else if (keyword == Keyword::Break || keyword == Keyword::Continue) {
+    JumpNode* node = NewNode<JumpNode>();
+    node->keyword = keyword;
+    node->text = curLex_.get_text();
     GetLexem();
-  } else {
-    throw std::runtime_error("Unexpected keyword: " + keyword + " at line " +
-                             std::to_string(curLex_.get_line()));
+    AnalyzeStatementTerminator();
+    return node;
   }
+  throw std::runtime_error(
+      "Unexpected keyword: " + std::string(curLex_.get_text()) +
+      " at line " + std::to_string(curLex_.get_line()));
 }
 
 /**
@@ -105,33 +153,28 @@ void SyntaxAnalyzer::AnalyzeStatement() {
  * 3. Processing all statements within the else block until a DEDENT or EOC is encountered
  * 
  * The method expects the current lexeme to be positioned at 'else' when called.
+ * 
+ * @return Block The statements of the else block
  */
-void SyntaxAnalyzer::AnalyzeElseStatement() {
+Block SyntaxAnalyzer::AnalyzeElseStatement() {
   GetLexem();
-  if (curLex_.get_text() != ":") {
+  if (curLex_.get_symbol() != Symbol::Colon) {
     throw std::runtime_error("Expected ':' after 'else' at line " +
                              std::to_string(curLex_.get_line()));
   }
   GetLexem();
 
-  if (curLex_.get_type() == "NEWLINE") {
+  if (curLex_.get_type() == LexemType::NEWLINE) {
     GetLexem();
   }
 
-  if (curLex_.get_type() != "INDENT") {
+  if (curLex_.get_type() != LexemType::INDENT) {
     throw std::runtime_error(
         "Expected indented block in else statement at line " +
         std::to_string(curLex_.get_line()));
   }
   GetLexem();
-
-  while (curLex_.get_type() != "DEDENT" && curLex_.get_type() != "EOC") {
-    AnalyzeStatement();
-  }
-
-  if (curLex_.get_type() == "DEDENT") {
-    GetLexem();
-  }
+  return AnalyzeBlock();
 }
 
 /**
@@ -153,51 +196,60 @@ void SyntaxAnalyzer::AnalyzeElseStatement() {
  *         - An identifier is missing after the type
  *         - A closing bracket ']' is missing in array declaration
  *         - A closing brace '}' is missing in array initialization
+ * @return Statement* The DeclarationNode
  */
-void SyntaxAnalyzer::AnalyzeVariableDeclaration() {
-  std::string type = curLex_.get_text();
+Statement* SyntaxAnalyzer::AnalyzeVariableDeclaration() {
+  DeclarationNode* node = NewNode<DeclarationNode>();
+  node->typeName = curLex_.get_text();
+  node->type = FindValueType(node->typeName);
   GetLexem();
-  if (curLex_.get_type() != "IDENTIFIER") {
+  if (curLex_.get_type() != LexemType::IDENTIFIER) {
     throw std::runtime_error("Expected identifier after type at line " +
                              std::to_string(curLex_.get_line()));
   }
+  node->name = curLex_.get_id();
   GetLexem();
 
-  if (curLex_.get_text() == "[") {
+  if (curLex_.get_symbol() == Symbol::LeftBracket) {
     GetLexem();
-    AnalyzeExpression();
+    node->size = AnalyzeExpression();
 
-    if (curLex_.get_text() != "]") {
+    if (curLex_.get_symbol() != Symbol::RightBracket) {
       throw std::runtime_error("Expected ']' in array declaration at line " +
                                std::to_string(curLex_.get_line()));
     }
     GetLexem();
   }
 
-  if (curLex_.get_text() == "=") {
+  if (curLex_.get_symbol() == Symbol::Assign) {
     GetLexem();
-    if (curLex_.get_text() == "{") {
+    if (curLex_.get_symbol() == Symbol::LeftBrace) {
       GetLexem();
 
-      while (curLex_.get_text() != "}" && curLex_.get_type() != "EOC") {
-        AnalyzeExpression();
-        if (curLex_.get_text() == ",") {
-          GetLexem();
+      std::vector<Expression*> elements;
+      while (curLex_.get_symbol() != Symbol::RightBrace &&
+             curLex_.get_type() != LexemType::EOC) {
+        elements.push_back(AnalyzeExpression());
+        if (curLex_.get_symbol() != Symbol::Comma) {
+          break;
         }
+        GetLexem();
       }
 
-      if (curLex_.get_text() != "}") {
+      if (curLex_.get_symbol() != Symbol::RightBrace) {
         throw std::runtime_error(
             "Expected '}' in array initialization at line " +
             std::to_string(curLex_.get_line()));
       }
       GetLexem();
+      node->elements = Span<Expression*>::Copy(ast_.arena, elements);
     } else {
-      AnalyzeExpression();
+      node->value = AnalyzeExpression();
     }
   }
 
   AnalyzeStatementTerminator();
+  return node;
 }
 
 /**
@@ -220,50 +272,48 @@ void SyntaxAnalyzer::AnalyzeVariableDeclaration() {
  * 
  * @throws std::runtime_error If any part of the function declaration syntax is invalid,
  *         with specific error messages indicating the line number where the error occurred.
+ * @return Statement* The FunctionNode
  */
-void SyntaxAnalyzer::AnalyzeFunctionDeclaration() {
+Statement* SyntaxAnalyzer::AnalyzeFunctionDeclaration() {
+  FunctionNode* node = NewNode<FunctionNode>();
   GetLexem();
 
-  if (curLex_.get_type() != "IDENTIFIER") {
+  if (curLex_.get_type() != LexemType::IDENTIFIER) {
     throw std::runtime_error("Expected function name at line " +
                              std::to_string(curLex_.get_line()));
   }
+  node->name = curLex_.get_id();
   GetLexem();
 
-  if (curLex_.get_text() != "(") {
+  if (curLex_.get_symbol() != Symbol::LeftParen) {
     throw std::runtime_error("Expected '(' after function name at line " +
                              std::to_string(curLex_.get_line()));
   }
   GetLexem();
 
-  AnalyzeParameterList();
+  node->parameters = AnalyzeParameterList();
 
-  if (curLex_.get_text() != ":") {
+  if (curLex_.get_symbol() != Symbol::Colon) {
     throw std::runtime_error("Expected ':' after function parameters at line " +
                              std::to_string(curLex_.get_line()));
   }
   GetLexem();
 
-  if (curLex_.get_type() != "NEWLINE") {
+  if (curLex_.get_type() != LexemType::NEWLINE) {
     throw std::runtime_error("Expected newline after ':' at line " +
                              std::to_string(curLex_.get_line()));
   }
   GetLexem();
 
-  if (curLex_.get_type() != "INDENT") {
+  if (curLex_.get_type() != LexemType::INDENT) {
     throw std::runtime_error(
         "Expected indented block after function declaration at line " +
         std::to_string(curLex_.get_line()));
   }
   GetLexem();
 
-  while (curLex_.get_type() != "DEDENT" && curLex_.get_type() != "EOC") {
-    AnalyzeStatement();
-  }
-
-  if (curLex_.get_type() == "DEDENT") {
-    GetLexem();
-  }
+  node->body = AnalyzeBlock();
+  return node;
 }
 
 /**
@@ -275,115 +325,211 @@ void SyntaxAnalyzer::AnalyzeFunctionDeclaration() {
  * - Parameters are properly separated by commas
  * The method advances through lexemes until reaching the closing parenthesis.
  * 
+ * @return Span<Parameter> The type and name of every parameter
  * @throws std::runtime_error If parameter type is invalid or parameter name is missing
  */
-void SyntaxAnalyzer::AnalyzeParameterList() {
-  while (curLex_.get_text() != ")") {
-    if (!IsType(curLex_.get_text())) {
+Span<Parameter> SyntaxAnalyzer::AnalyzeParameterList() {
+  std::vector<Parameter> parameters;
+  while (curLex_.get_symbol() != Symbol::RightParen) {
+    if (!IsType(curLex_.get_keyword())) {
       throw std::runtime_error("Expected type in parameter list at line " +
                                std::to_string(curLex_.get_line()));
     }
+    Parameter parameter;
+    parameter.type = curLex_.get_text();
     GetLexem();
 
-    if (curLex_.get_type() != "IDENTIFIER") {
+    if (curLex_.get_type() != LexemType::IDENTIFIER) {
       throw std::runtime_error("Expected parameter name at line " +
                                std::to_string(curLex_.get_line()));
     }
+    parameter.name = curLex_.get_id();
+    parameters.push_back(parameter);
     GetLexem();
 
-    if (curLex_.get_text() == ",") {
+    if (curLex_.get_symbol() == Symbol::Comma) {
       GetLexem();
     }
   }
   GetLexem();
+  return Span<Parameter>::Copy(ast_.arena, parameters);
 }
 
 /**
- * @brief Checks if a given word is a valid SIGMA type identifier.
+ * @brief Checks if a given keyword is a valid SIGMA type identifier.
  * 
- * @param word String to check against valid type identifiers.
- * @return true if the word matches any of the valid types (int, float, bool, string, void)
+ * @param keyword Keyword id of the lexem to check.
+ * @return true if the keyword is one of the valid types (int, float, bool,
+ *         string, void)
  * @return false otherwise
  */
-bool SyntaxAnalyzer::IsType(const std::string& word) {
-  return word == "int" || word == "float" || word == "bool" ||
-         word == "string" || word == "void";
+bool SyntaxAnalyzer::IsType(Keyword keyword) {
+  return keyword == Keyword::Int || keyword == Keyword::Float ||
+         keyword == Keyword::Bool || keyword == Keyword::String ||
+         keyword == Keyword::Void;
 }
 
-void SyntaxAnalyzer::AnalyzeAssignment() {
+/**
+ * @brief Analyzes a statement that starts with an identifier: an assignment
+ * "name = expression" or a call "name(arguments)".
+ *
+ * @return Statement* The AssignmentNode or CallNode
+ * @throws std::runtime_error If the identifier is followed by anything else
+ */
+Statement* SyntaxAnalyzer::AnalyzeAssignment() {
+  if (curLex_.get_type() != LexemType::IDENTIFIER) {
+    throw std::runtime_error(
+        "Unexpected token: " + std::string(curLex_.get_text()) +
+        " at line " + std::to_string(curLex_.get_line()));
+  }
+  SymbolId name = curLex_.get_id();
+  size_t line = curLex_.get_line();
   GetLexem();
 
-  if (curLex_.get_text() == "(") {
-    GetLexem();
-    while (curLex_.get_text() != ")") {
-      AnalyzeExpression();
-      if (curLex_.get_text() == ",") {
-        GetLexem();
-      }
-    }
+  if (curLex_.get_symbol() == Symbol::LeftParen) {
+    CallNode* node = NewNode<CallNode>();
+    node->line = line;
+    node->name = name;
     GetLexem();
+    node->arguments = AnalyzeArguments();
     AnalyzeStatementTerminator();
-    return;
+    return node;
   }
+  if (curLex_.get_symbol() != Symbol::Assign) {
+    throw std::runtime_error("Expected '=' or '(' after " +
+                             std::string(SymbolName(name)) +
+                             " at line " + std::to_string(line));
+  }
+  AssignmentNode* node = NewNode<AssignmentNode>();
+  node->line = line;
+  node->name = name;
   GetLexem();
 
-  AnalyzeExpression();
+  node->value = AnalyzeExpression();
   AnalyzeStatementTerminator();
+  return node;
+}
+
+/**
+ * @brief Analyzes the comma separated arguments of a call up to and
+ * including the closing parenthesis.
+ *
+ * @return Span<Expression*> One expression per argument
+ * @throws std::runtime_error If the list is not closed with ')'
+ */
+Span<Expression*> SyntaxAnalyzer::AnalyzeArguments() {
+  std::vector<Expression*> arguments;
+  while (curLex_.get_symbol() != Symbol::RightParen) {
+    arguments.push_back(AnalyzeExpression());
+    if (curLex_.get_symbol() == Symbol::Comma) {
+      GetLexem();
+    } else if (curLex_.get_symbol() != Symbol::RightParen) {
+      throw std::runtime_error("Expected ',' or ')' in call at line " +
+                               std::to_string(curLex_.get_line()));
+    }
+  }
+  GetLexem();
+  return Span<Expression*>::Copy(ast_.arena, arguments);
 }
 
-void SyntaxAnalyzer::AnalyzeExpression() {
-  while (curLex_.get_type() != "NEWLINE" && curLex_.get_text() != ";" &&
-         curLex_.get_text() != ")" && curLex_.get_text() != "," &&
-         curLex_.get_text() != "]" && curLex_.get_type() != "EOC" &&
-         curLex_.get_text() != "}") {
+/**
+ * @brief Collects the lexemes of an expression into an Expression node.
+ *
+ * The expression ends at a newline, at the end of code or at a ';', ':',
+ * ',' or closing bracket that is not inside a pair of brackets of the
+ * expression itself; the delimiter is left as the current lexeme.
+ *
+ * @return Expression* The expression, without tokens if it is empty
+ */
+Expression* SyntaxAnalyzer::AnalyzeExpression() {
+  Expression* expression = ast_.arena.New<Expression>();
+  expression->line = curLex_.get_line();
+  tokens_.clear();
+  int depth = 0;
+  while (curLex_.get_type() != LexemType::NEWLINE &&
+         curLex_.get_type() != LexemType::EOC) {
+    Symbol symbol = curLex_.get_symbol();
+    if (symbol == Symbol::LeftParen || symbol == Symbol::LeftBracket ||
+        symbol == Symbol::LeftBrace) {
+      ++depth;
+    } else if (symbol == Symbol::RightParen ||
+               symbol == Symbol::RightBracket ||
+               symbol == Symbol::RightBrace) {
+      if (depth == 0) {
+        break;
+      }
+      --depth;
+    } else if (depth == 0 &&
+               (symbol == Symbol::Semicolon || symbol == Symbol::Colon ||
+                symbol == Symbol::Comma)) {
+      break;
+    }
+    tokens_.push_back(curLex_);
     GetLexem();
   }
+  expression->tokens = Span<Lexem>::Copy(ast_.arena, tokens_);
+  return expression;
 }
 
 void SyntaxAnalyzer::AnalyzeStatementTerminator() {
-  if (curLex_.get_text() == ";") {
+  if (curLex_.get_symbol() == Symbol::Semicolon) {
     GetLexem();
   }
-  if (curLex_.get_type() == "NEWLINE") {
+  if (curLex_.get_type() == LexemType::NEWLINE) {
     GetLexem();
   }
 }
 
-void SyntaxAnalyzer::AnalyzeIfStatement() {
+/**
+ * @brief Analyzes an 'if' statement and the 'else' block that may follow
+ * its block.
+ *
+ * @return Statement* The IfNode
+ * @throws std::runtime_error If the condition is not in parentheses
+ *         followed by ':' or a block is not indented
+ */
+Statement* SyntaxAnalyzer::AnalyzeIfStatement() {
+  IfNode* node = NewNode<IfNode>();
   GetLexem();
 
-  if (curLex_.get_text() != "(") {
+  if (curLex_.get_symbol() != Symbol::LeftParen) {
     throw std::runtime_error("Expected '(' after 'if' at line " +
                              std::to_string(curLex_.get_line()));
   }
   GetLexem();
 
-  AnalyzeExpression();
+  node->condition = AnalyzeExpression();
+  if (curLex_.get_symbol() != Symbol::RightParen) {
+    throw std::runtime_error("Expected ')' after if condition at line " +
+                             std::to_string(curLex_.get_line()));
+  }
   GetLexem();
-  if (curLex_.get_text() != ":") {
+  if (curLex_.get_symbol() != Symbol::Colon) {
     throw std::runtime_error("Expected ':' after if condition at line " +
                              std::to_string(curLex_.get_line()));
   }
   GetLexem();
 
-  if (curLex_.get_type() == "NEWLINE") {
+  if (curLex_.get_type() == LexemType::NEWLINE) {
     GetLexem();
   }
 
-  if (curLex_.get_type() != "INDENT") {
+  if (curLex_.get_type() != LexemType::INDENT) {
     throw std::runtime_error(
         "Expected indented block in if statement at line " +
         std::to_string(curLex_.get_line()));
   }
   GetLexem();
 
-  while (curLex_.get_type() != "DEDENT" && curLex_.get_type() != "EOC") {
-    AnalyzeStatement();
-  }
-
-  if (curLex_.get_type() == "DEDENT") {
+  node->then = AnalyzeBlock();
+  while (curLex_.get_type() == LexemType::NEWLINE) {
     GetLexem();
   }
+  if (curLex_.get_keyword() == Keyword::Else) {
+    node->hasElse = true;
+    node->otherwise = AnalyzeElseStatement();
+  }
+  return node;
 }
 
 /**
@@ -403,56 +549,56 @@ void SyntaxAnalyzer::AnalyzeIfStatement() {
  *         - Missing opening parenthesis
  *         - Missing colon after condition
  *         - Missing indentation for the loop body
+ * @return Statement* The WhileNode
  */
-void SyntaxAnalyzer::AnalyzeWhileStatement() {
+Statement* SyntaxAnalyzer::AnalyzeWhileStatement() {
+  WhileNode* node = NewNode<WhileNode>();
   GetLexem();  // Skip 'while'
 
-  if (curLex_.get_text() != "(") {
+  if (curLex_.get_symbol() != Symbol::LeftParen) {
     throw std::runtime_error("Expected '(' after 'while' at line " +
                              std::to_string(curLex_.get_line()));
   }
   GetLexem();
 
-  AnalyzeExpression();
-
+  node->condition = AnalyzeExpression();
+  if (curLex_.get_symbol() != Symbol::RightParen) {
+    throw std::runtime_error("Expected ')' after while condition at line " +
+                             std::to_string(curLex_.get_line()));
+  }
   GetLexem();
-  if (curLex_.get_text() != ":") {
+  if (curLex_.get_symbol() != Symbol::Colon) {
     throw std::runtime_error("Expected ':' after while condition at line " +
                              std::to_string(curLex_.get_line()));
   }
   GetLexem();
 
-  if (curLex_.get_type() == "NEWLINE") {
+  if (curLex_.get_type() == LexemType::NEWLINE) {
     GetLexem();
   }
 
-  if (curLex_.get_type() != "INDENT") {
+  if (curLex_.get_type() != LexemType::INDENT) {
     throw std::runtime_error(
         "Expected indented block in while statement at line " +
         std::to_string(curLex_.get_line()));
   }
   GetLexem();
 
-  while (curLex_.get_type() != "DEDENT" && curLex_.get_type() != "EOC") {
-    AnalyzeStatement();
-  }
-
-  if (curLex_.get_type() == "DEDENT") {
-    GetLexem();
-  }
+  node->body = AnalyzeBlock();
+  return node;
 }
 
 /**
  * @brief Analyzes the syntax of a 'for' loop statement in the source code.
  * 
  * This method handles the parsing of Python-style for loops with the following structure:
- * for identifier in expression:
+ * for identifier in range(expression):
  *     indented_block
  *
  * The method verifies:
  * - Presence of an identifier after 'for' keyword
  * - Presence of 'in' keyword after identifier
- * - Valid expression after 'in'
+ * - Presence of 'range' and a bound in parentheses after 'in'
  * - Proper colon after the expression
  * - Proper indentation of the loop body
  * - Valid statements within the loop body
@@ -460,48 +606,60 @@ void SyntaxAnalyzer::AnalyzeWhileStatement() {
  *
  * @throws std::runtime_error if any syntax rules are violated, with detailed error message
  *         including the line number where the error occurred
+ * @return Statement* The ForNode
  */
-void SyntaxAnalyzer::AnalyzeForStatement() {
+Statement* SyntaxAnalyzer::AnalyzeForStatement() {
+  ForNode* node = NewNode<ForNode>();
   GetLexem();
 
-  if (curLex_.get_type() != "IDENTIFIER") {
+  if (curLex_.get_type() != LexemType::IDENTIFIER) {
     throw std::runtime_error("Expected identifier after 'for' at line " +
                              std::to_string(curLex_.get_line()));
   }
+  node->variable = curLex_.get_id();
   GetLexem();
-  if (curLex_.get_text() != "in") {
+  if (curLex_.get_keyword() != Keyword::In) {
     throw std::runtime_error(
         "Expected 'in' after identifier in for loop at line " +
         std::to_string(curLex_.get_line()));
   }
   GetLexem();
+  if (curLex_.get_keyword() != Keyword::Range) {
+    throw std::runtime_error("Expected 'range' after 'in' at line " +
+                             std::to_string(curLex_.get_line()));
+  }
+  GetLexem();
+  if (curLex_.get_symbol() != Symbol::LeftParen) {
+    throw std::runtime_error("Expected '(' after 'range' at line " +
+                             std::to_string(curLex_.get_line()));
+  }
+  GetLexem();
 
-  AnalyzeExpression();
+  node->bound = AnalyzeExpression();
+  if (curLex_.get_symbol() != Symbol::RightParen) {
+    throw std::runtime_error("Expected ')' after range bound at line " +
+                             std::to_string(curLex_.get_line()));
+  }
   GetLexem();
-  if (curLex_.get_text() != ":") {
+  if (curLex_.get_symbol() != Symbol::Colon) {
     throw std::runtime_error("Expected ':' after for expression at line " +
                              std::to_string(curLex_.get_line()));
   }
   GetLexem();
 
-  if (curLex_.get_type() == "NEWLINE") {
+  if (curLex_.get_type() == LexemType::NEWLINE) {
     GetLexem();
   }
 
-  if (curLex_.get_type() != "INDENT") {
+  if (curLex_.get_type() != LexemType::INDENT) {
     throw std::runtime_error(
         "Expected indented block in for statement at line " +
         std::to_string(curLex_.get_line()));
   }
   GetLexem();
 
-  while (curLex_.get_type() != "DEDENT" && curLex_.get_type() != "EOC") {
-    AnalyzeStatement();
-  }
-
-  if (curLex_.get_type() == "DEDENT") {
-    GetLexem();
-  }
+  node->body = AnalyzeBlock();
+  return node;
 }
 
 /**
@@ -520,25 +678,28 @@ void SyntaxAnalyzer::AnalyzeForStatement() {
  *         - Missing opening parenthesis after 'print'
  *         - Missing closing parenthesis after the expression
  *         - Missing or invalid statement terminator
+ * @return Statement* The PrintNode
  */
-void SyntaxAnalyzer::AnalyzePrintStatement() {
+Statement* SyntaxAnalyzer::AnalyzePrintStatement() {
+  PrintNode* node = NewNode<PrintNode>();
   GetLexem();
 
-  if (curLex_.get_text() != "(") {
+  if (curLex_.get_symbol() != Symbol::LeftParen) {
     throw std::runtime_error("Expected '(' after 'print' at line " +
                              std::to_string(curLex_.get_line()));
   }
   GetLexem();
 
-  AnalyzeExpression();
+  node->value = AnalyzeExpression();
 
-  if (curLex_.get_text() != ")") {
+  if (curLex_.get_symbol() != Symbol::RightParen) {
     throw std::runtime_error("Expected ')' after print expression at line " +
                              std::to_string(curLex_.get_line()));
   }
   GetLexem();
 
   AnalyzeStatementTerminator();
+  return node;
 }
 
 /**
@@ -555,13 +716,16 @@ void SyntaxAnalyzer::AnalyzePrintStatement() {
  * - return       // empty return
  * - return x     // return with expression
  * - return 1 + 2 // return with complex expression
+ * 
+ * @return Statement* The ReturnNode; its value has no tokens for an empty
+ *         return
  */
-void SyntaxAnalyzer::AnalyzeReturnStatement() {
+Statement* SyntaxAnalyzer::AnalyzeReturnStatement() {
+  ReturnNode* node = NewNode<ReturnNode>();
   GetLexem();
 
-  if (curLex_.get_type() != "NEWLINE") {
-    AnalyzeExpression();
-  }
+  node->value = AnalyzeExpression();
 
   AnalyzeStatementTerminator();
+  return node;
 }
@@ -0,0 +1,238 @@
+#include "Value.h"
+#include <cctype>
+#include <cmath>
+#include <sstream>
+#include <stdexcept>
+
+/**
+ * @brief Returns the value as an integer, truncating floats.
+ *
+ * @throws std::runtime_error if the value is a string
+ */
+long long Value::AsInt() const {
+  if (IsInt()) {
+    return std::get<long long>(data_);
+  }
+  if (IsFloat()) {
+    return static_cast<long long>(std::get<double>(data_));
+  }
+  throw std::runtime_error("Expected number, got string \"" + AsString() +
+                           "\"");
+}
+
+/**
+ * @brief Returns the value as a floating point number, promoting ints.
+ *
+ * @throws std::runtime_error if the value is a string
+ */
+double Value::AsFloat() const {
+  if (IsFloat()) {
+    return std::get<double>(data_);
+  }
+  if (IsInt()) {
+    return static_cast<double>(std::get<long long>(data_));
+  }
+  throw std::runtime_error("Expected number, got string \"" + AsString() +
+                           "\"");
+}
+
+/**
+ * @brief Returns the stored string.
+ *
+ * @throws std::runtime_error if the value is a number
+ */
+const std::string& Value::AsString() const {
+  if (!IsString()) {
+    throw std::runtime_error("Expected string, got number " + ToString());
+  }
+  return std::get<std::string>(data_);
+}
+
+/**
+ * @brief Checks the value in a condition: non-zero numbers and non-empty
+ * strings are true.
+ */
+bool Value::IsTruthy() const {
+  if (IsInt()) {
+    return std::get<long long>(data_) != 0;
+  }
+  if (IsFloat()) {
+    return std::get<double>(data_) != 0.0;
+  }
+  return !std::get<std::string>(data_).empty();
+}
+
+/**
+ * @brief Formats the value the way print() shows it.
+ */
+std::string Value::ToString() const {
+  if (IsInt()) {
+    return std::to_string(std::get<long long>(data_));
+  }
+  if (IsFloat()) {
+    std::ostringstream out;
+    out << std::get<double>(data_);
+    return out.str();
+  }
+  return std::get<std::string>(data_);
+}
+
+/**
+ * @brief Builds a value from the text of a literal operand.
+ *
+ * @param literal Either a quoted string ("text") or a number (42, 3.14)
+ * @throws std::runtime_error if the text is not a literal
+ */
+Value Value::FromLiteral(const std::string& literal) {
+  if (literal.size() >= 2 && literal.front() == '"' && literal.back() == '"') {
+    return Value(literal.substr(1, literal.size() - 2));
+  }
+  if (literal.empty() || !(isdigit(literal[0]) || literal[0] == '.')) {
+    throw std::runtime_error("Not a literal: " + literal);
+  }
+  if (literal.find('.') != std::string::npos) {
+    return Value(std::stod(literal));
+  }
+  return Value(std::stoll(literal));
+}
+
+/**
+ * @brief Applies a binary operator to two values.
+ *
+ * And and Or accept any operands and test their truthiness. Otherwise
+ * strings only support concatenation and comparison with other strings.
+ * Integer operands stay integers (division truncates, the remainder takes
+ * the sign of the dividend), any float operand promotes the result to
+ * float. Comparisons and logical operators produce the integers 0 and 1.
+ *
+ * @throws std::runtime_error on type mismatch or division by zero
+ */
+Value Value::Apply(Operator op, const Value& lhs, const Value& rhs) {
+  if (op == Operator::And) {
+    return Value(static_cast<long long>(lhs.IsTruthy() && rhs.IsTruthy()));
+  }
+  if (op == Operator::Or) {
+    return Value(static_cast<long long>(lhs.IsTruthy() || rhs.IsTruthy()));
+  }
+
+  if (lhs.IsString() || rhs.IsString()) {
+    if (!lhs.IsString() || !rhs.IsString()) {
+      throw std::runtime_error("Type mismatch: cannot combine " +
+                               lhs.ToString() + " and " + rhs.ToString());
+    }
+    const std::string& a = lhs.AsString();
+    const std::string& b = rhs.AsString();
+    switch (op) {
+      case Operator::Add:
+        return Value(a + b);
+      case Operator::Less:
+        return Value(static_cast<long long>(a < b));
+      case Operator::Greater:
+        return Value(static_cast<long long>(a > b));
+      case Operator::LessEqual:
+        return Value(static_cast<long long>(a <= b));
+      case Operator::GreaterEqual:
+        return Value(static_cast<long long>(a >= b));
+      case Operator::Equal:
+        return Value(static_cast<long long>(a == b));
+      case Operator::NotEqual:
+        return Value(static_cast<long long>(a != b));
+      default:
+        throw std::runtime_error("Unsupported operation on strings");
+    }
+  }
+
+  if (lhs.IsInt() && rhs.IsInt()) {
+    long long a = lhs.AsInt();
+    long long b = rhs.AsInt();
+    switch (op) {
+      case Operator::Add:
+        return Value(a + b);
+      case Operator::Sub:
+        return Value(a - b);
+      case Operator::Mul:
+        return Value(a * b);
+      case Operator::Div:
+        if (b == 0) {
+          throw std::runtime_error("Division by zero");
+        }
+        return Value(a / b);
+      case Operator::Mod:
+        if (b == 0) {
+          throw std::runtime_error("Division by zero");
+        }
+        return Value(a % b);
+      case Operator::Less:
+        return Value(static_cast<long long>(a < b));
+      case Operator::Greater:
+        return Value(static_cast<long long>(a > b));
+      case Operator::LessEqual:
+        return Value(static_cast<long long>(a <= b));
+      case Operator::GreaterEqual:
+        return Value(static_cast<long long>(a >= b));
+      case Operator::Equal:
+        return Value(static_cast<long long>(a == b));
+      case Operator::NotEqual:
+        return Value(static_cast<long long>(a != b));
+      default:
+        throw std::runtime_error("Unknown operator");
+    }
+  }
+
+  double a = lhs.AsFloat();
+  double b = rhs.AsFloat();
+  switch (op) {
+    case Operator::Add:
+      return Value(a + b);
+    case Operator::Sub:
+      return Value(a - b);
+    case Operator::Mul:
+      return Value(a * b);
+    case Operator::Div:
+      if (b == 0.0) {
+        throw std::runtime_error("Division by zero");
+      }
+      return Value(a / b);
+    case Operator::Mod:
+      if (b == 0.0) {
+        throw std::runtime_error("Division by zero");
+      }
+      return Value(std::fmod(a, b));
+    case Operator::Less:
+      return Value(static_cast<long long>(a < b));
+    case Operator::Greater:
+      return Value(static_cast<long long>(a > b));
+    case Operator::LessEqual:
+      return Value(static_cast<long long>(a <= b));
+    case Operator::GreaterEqual:
+      return Value(static_cast<long long>(a >= b));
+    case Operator::Equal:
+      return Value(static_cast<long long>(a == b));
+    case Operator::NotEqual:
+      return Value(static_cast<long long>(a != b));
+    default:
+      throw std::runtime_error("Unknown operator");
+  }
+}
+
+/**
+ * @brief Applies a unary operator to a value.
+ *
+ * Not accepts any operand and produces 0 or 1, Negate keeps the type of a
+ * number.
+ *
+ * @throws std::runtime_error when negating a string
+ */
+Value Value::Apply(Operator op, const Value& operand) {
+  switch (op) {
+    case Operator::Not:
+      return Value(static_cast<long long>(!operand.IsTruthy()));
+    case Operator::Negate:
+      if (operand.IsInt()) {
+        return Value(-operand.AsInt());
+      }
+      return Value(-operand.AsFloat());
+    default:
+      throw std::runtime_error("Unknown operator");
+  }
+}
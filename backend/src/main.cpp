@@ -1,11 +1,10 @@
-#include <Codegen.h>
-#include <RPN.h>
-#include <SyntaxAnalyzer.h>
-#include <fstream>
+#include <cstdlib>
 #include <iostream>
-#include <sstream>
+#include "CompileCache.h"
+#include "Driver.h"
 #include "LexemAnalyzer.h"
-#include "Semantic.h"
+#include "Server.h"
+#include "SourceBuffer.h"
 
 /**
  * @brief Main entry point of the SIGMA interpreter program
@@ -14,51 +13,137 @@
  * @return 0 on successful execution, 1 on error
  *
  * The program expects two optional command line arguments:
- * 1. Path to the code file (defaults to "../test/code.us")
- * 2. Path to the workwords file (defaults to "../test/workword")
+ * 1. Path to the code file (defaults to "../test/code.us", "-" reads the
+ *    program from standard input)
+ * 2. Path to a custom workwords file (the built-in keywords are used when
+ *    it is omitted)
+ *
+ * Options may appear anywhere on the command line:
+ * --keywords=path  load a custom keyword file, same as the second argument
+ * --lex-threads=N  lex the whole program up front with up to N threads (0:
+ *                one per hardware thread) instead of lexing it while it
+ *                is parsed (the default, same as 1)
+ * -O0, -O1      optimization level of the RPN program (default -O1)
+ * --stats       report what the optimizer removed on stderr
+ * --vm=stack     execute the bytecode on the StackMachine (default)
+ * --vm=register  lower the bytecode to three-address code and execute it
+ *                on the RegisterMachine
+ * --jit-threshold=N  compile functions called N times to native code
+ *                (StackMachine only, 0 disables the JIT)
+ * --emit=cpp     translate the program to C++ instead of running it; the
+ *                source goes to stdout or to the file given with -o
+ * --emit=binary  translate to C++ and build the executable given with -o
+ *                with clang++ (or $SIGMA_CXX)
+ * --serve        stay resident and run the programs sent on standard input
+ *                (see Server.h); takes no code file, keywords are given
+ *                with --keywords=
+ * --serve=path   the same on a Unix domain socket at path
+ * --cache-dir=path  reuse the programs compiled earlier with the same
+ *                source, keywords and optimization level, kept in the
+ *                directory at path (see CompileCache.h)
+ * --cache-size=N  bound the cache directory to N bytes (default 64 MiB)
+ * --compile-only -o prog.usc  compile the program to a program image (see
+ *                ProgramImage.h) instead of running it
+ * --run prog.usc  run a program image; takes no code file or keywords
  *
  * Program flow:
  * 1. Validates command line arguments
- * 2. Opens and reads the code file
- * 3. Performs lexical analysis using LexemAnalyzer
- * 4. Performs semantic analysis using Semantic analyzer
+ * 2. Maps the code file into memory (or reads it when it cannot be mapped)
+ * 3. Compiles and runs it with RunProgram(), or maps and runs the program
+ *    image given with --run with RunImage()
  *
  * @throws std::runtime_error if code file cannot be opened
  * @throws Any exceptions from LexemAnalyzer or Semantic analysis
  */
 int main(int argc, char* argv[]) {
-  if (argc > 1 && argc < 3) {
+  std::vector<std::string> arguments;
+  RunOptions options;
+  std::string keywordsPath;
+  bool serve = false;
+  std::string socketPath;
+  std::string imagePath;
+  std::string cacheDirectory;
+  uint64_t cacheCapacity = CompileCache::kDefaultCapacity;
+  for (int i = 1; i < argc; ++i) {
+    std::string argument = argv[i];
+    if (argument == "-O0" || argument == "-O1") {
+      options.optimizationLevel = argument[2] - '0';
+    } else if (argument.rfind("--keywords=", 0) == 0) {
+      keywordsPath = argument.substr(11);
+    } else if (argument.rfind("--lex-threads=", 0) == 0) {
+      options.lexThreads = std::strtoul(argument.c_str() + 14, nullptr, 10);
+    } else if (argument == "--stats") {
+      options.printStats = true;
+    } else if (argument == "-o" && i + 1 < argc) {
+      options.outputPath = argv[++i];
+    } else if (argument == "--compile-only") {
+      options.compileOnly = true;
+    } else if (argument == "--run" && i + 1 < argc) {
+      imagePath = argv[++i];
+    } else if (argument == "--emit=cpp" || argument == "--emit=binary") {
+      options.emit = argument.substr(7);
+    } else if (argument == "--vm=register" || argument == "--vm=stack") {
+      options.useRegisterMachine = argument == "--vm=register";
+    } else if (argument.rfind("--jit-threshold=", 0) == 0) {
+      options.jitThreshold =
+          std::strtoul(argument.c_str() + 16, nullptr, 10);
+    } else if (argument == "--serve" || argument.rfind("--serve=", 0) == 0) {
+      serve = true;
+      socketPath = argument.substr(argument.size() > 7 ? 8 : 7);
+    } else if (argument.rfind("--cache-dir=", 0) == 0) {
+      cacheDirectory = argument.substr(12);
+    } else if (argument.rfind("--cache-size=", 0) == 0) {
+      cacheCapacity = std::strtoull(argument.c_str() + 13, nullptr, 10);
+    } else if (argument.rfind("-", 0) == 0 && argument != "-") {
+      std::cerr << "Unknown option '" << argument << "'" << std::endl;
+      return 1;
+    } else {
+      arguments.push_back(argument);
+    }
+  }
+
+  if (arguments.size() > 2 ||
+      (options.emit == "binary" && options.outputPath.empty()) ||
+      (options.compileOnly &&
+       (options.outputPath.empty() || !options.emit.empty())) ||
+      (!imagePath.empty() &&
+       (!arguments.empty() || !keywordsPath.empty() || options.compileOnly ||
+        !options.emit.empty())) ||
+      (serve && (!arguments.empty() || !options.emit.empty() ||
+                 options.compileOnly || !imagePath.empty()))) {
     std::cerr << "Use: " << argv[0]
-              << " <path to code file> <path to workwords file>" << std::endl;
+              << " [-O0|-O1] [--stats] [--vm=stack|register] "
+                 "[--jit-threshold=N] "
+                 "[--emit=cpp|binary [-o output] | --compile-only -o "
+                 "prog.usc | --run prog.usc] [--keywords=path] "
+                 "[--lex-threads=N] [--cache-dir=path [--cache-size=N]] "
+                 "[--serve[=socket path] | <path to "
+                 "code file> [<path to workwords file>]]"
+              << std::endl;
     return 1;
   }
 
-  std::string codePath = (argc != 1) ? argv[1] : "../test/code.us";
-  std::string workwordsPath = (argc != 1) ? argv[2] : "../test/workword";
+  std::string codePath = arguments.empty() ? "../test/code.us" : arguments[0];
+  if (arguments.size() > 1) {
+    keywordsPath = arguments[1];
+  }
 
   try {
-    std::ifstream codeFile(codePath);
-    if (!codeFile.is_open()) {
-      throw std::runtime_error("Failed to open code file '" + codePath + "'");
+    if (!keywordsPath.empty()) {
+      options.keywords = LexemAnalyzer::LoadKeywords(keywordsPath);
     }
-
-    std::stringstream codeBuffer;
-    codeBuffer << codeFile.rdbuf();
-    std::string code = codeBuffer.str();
-
-    LexemAnalyzer lexer(code, workwordsPath);
-    lexer.Analyze();
-    std::vector<Lexem> lexems = lexer.GetLexems();
-    SyntaxAnalyzer syntaxer(lexems);
-    syntaxer.Analyze();
-    SemanticAnalyzer semantic(lexems);
-    //semantic.Analyze();
-    RPN rpn(lexems);
-    rpn.buildRPN();
-    rpn.printRPN();
-    std::cout << "Code analysis completed successfully!" << std::endl;
-    CodeGen runner(code, rpn.getRPN());
-    return 0;
+    if (!cacheDirectory.empty()) {
+      options.cache =
+          std::make_shared<CompileCache>(cacheDirectory, cacheCapacity);
+    }
+    if (serve) {
+      return Serve(options, socketPath);
+    }
+    if (!imagePath.empty()) {
+      return RunImage(imagePath, options);
+    }
+    SourceBuffer code(codePath);
+    return RunProgram(code.View(), options);
   } catch (const std::exception& e) {
     std::cout << "Error: " << e.what() << std::endl;
     return 1;
@@ -1,4 +1,6 @@
+import select
 import subprocess
+import threading
 
 from fastapi import FastAPI, Request
 from fastapi.middleware.cors import CORSMiddleware  # Add this import
@@ -30,23 +32,46 @@ async def say_hello(name: str):
     return {"message": f"Hello {name}"}
 
 
+# One resident backend answers every /run (see backend/include/Server.h),
+# so a request does not pay for starting a process.
+backend = None
+backend_lock = threading.Lock()
+
+
+def run_in_backend(code, timeout):
+    global backend
+    with backend_lock:
+        if backend is None or backend.poll() is not None:
+            backend = subprocess.Popen(
+                ["./backend", "--serve", "--keywords=workword"],
+                stdin=subprocess.PIPE,
+                stdout=subprocess.PIPE,
+            )
+        source = code.encode()
+        backend.stdin.write(b"RUN %d\n" % len(source) + source)
+        backend.stdin.flush()
+        ready, _, _ = select.select([backend.stdout], [], [], timeout)
+        if not ready:
+            # The program never ended; the next request starts a new backend.
+            backend.kill()
+            backend = None
+            raise subprocess.TimeoutExpired("./backend --serve", timeout)
+        _, status, out_size, err_size = backend.stdout.readline().split()
+        output = backend.stdout.read(int(out_size)).decode()
+        error = backend.stdout.read(int(err_size)).decode()
+        return int(status), output, error
+
+
 @app.post("/run")
 async def run_code(request: Request):
     data = await request.json()
     code = data["code"]
     print(code)
-    with open("code.us", "w") as f:
-        f.write(code)
     try:
-        print("Running subprocess...")
-        result = subprocess.run(
-            ["./backend", "code.us", "workword"],
-            capture_output=True,
-            text=True,
-            timeout=5,
-        )
-        print("Subprocess finished.")
-        print(result.stdout)
-    except subprocess.CalledProcessError as e:
-        return {"output": e.output, "error": e.stderr}
-    return {"output": result.stdout, "error": None}
+        print("Running program...")
+        status, output, error = run_in_backend(code, timeout=5)
+        print("Program finished with status", status)
+        print(output)
+    except subprocess.TimeoutExpired:
+        return {"output": "", "error": "Timed out"}
+    return {"output": output, "error": None}